@@ -0,0 +1,308 @@
+/* wsdl2 benchmark suite
+ *
+ * Runs headless (SDL_VIDEODRIVER=dummy unless set otherwise) on the
+ * software renderer and prints the results as JSON, or writes them to
+ * the file given as first argument.
+ *
+ * The ttf benchmarks need a font, set WSDL2_BENCH_FONT to its path.
+ *
+ */
+
+#include "wsdl2/wsdl2.hpp"
+#include "wsdl2/video.hpp"
+#include "wsdl2/event.hpp"
+#include "wsdl2/timing.hpp"
+
+#ifdef WSDL2_TTF
+#include "wsdl2/ttf.hpp"
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <SDL2/SDL.h>
+}
+
+using namespace wsdl2;
+
+namespace {
+    struct result {
+        std::string name;
+        std::uint64_t iterations;
+        double seconds;
+    };
+
+    std::vector<result> _results;
+
+    // each benchmark runs for at least this long
+    constexpr double min_time = 0.25;
+
+    /// call f(n) with growing batches of n operations until min_time
+    void measure(const std::string& name, const std::function<void(std::uint64_t)>& f) {
+        // warm up caches and lazy initializations
+        f(1);
+
+        std::uint64_t total = 0;
+        std::uint64_t batch = 1;
+        double elapsed = 0;
+
+        while (elapsed < min_time) {
+            const std::uint64_t start = timing::now();
+            f(batch);
+            elapsed += timing::seconds(timing::now() - start);
+
+            total += batch;
+            if (batch < (1u << 20))
+                batch *= 2;
+        }
+
+        _results.push_back(result {name, total, elapsed});
+        std::cerr << name << ": " << (elapsed * 1e9 / static_cast<double>(total))
+                  << " ns/op\n";
+    }
+
+    std::string escape(const std::string& s) {
+        std::string out;
+        for (char c : s) {
+            if (c == '"' || c == '\\')
+                out += '\\';
+            out += c;
+        }
+
+        return out;
+    }
+
+    void write_json(std::ostream& out, const std::string& driver, const std::string& renderer) {
+        SDL_version v;
+        SDL_GetVersion(&v);
+
+        out << "{\n"
+            << "  \"suite\": \"wsdl2\",\n"
+            << "  \"sdl_version\": \"" << static_cast<int>(v.major) << "."
+                << static_cast<int>(v.minor) << "." << static_cast<int>(v.patch) << "\",\n"
+            << "  \"video_driver\": \"" << escape(driver) << "\",\n"
+            << "  \"renderer\": \"" << escape(renderer) << "\",\n"
+            << "  \"results\": [\n";
+
+        for (std::size_t i = 0; i < _results.size(); i++) {
+            const result& r = _results[i];
+            const double n = static_cast<double>(r.iterations);
+
+            out << "    {\"name\": \"" << escape(r.name) << "\""
+                << ", \"iterations\": " << r.iterations
+                << ", \"seconds\": " << r.seconds
+                << ", \"ns_per_op\": " << (r.seconds * 1e9 / n)
+                << ", \"ops_per_second\": " << (n / r.seconds)
+                << "}" << (i + 1 < _results.size() ? "," : "") << "\n";
+        }
+
+        out << "  ]\n}\n";
+    }
+
+    // keep the optimizer from dropping pure computations
+    volatile int _sink;
+
+    void bench_rect() {
+        const rect a {10, 20, 300, 200};
+        const rect b {150, 100, 300, 200};
+        const point p {200, 150};
+
+        measure("rect/intersects", [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i++)
+                _sink = a.intersects(b);
+        });
+
+        measure("rect/intersection", [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i++)
+                _sink = a.intersection(b)->w;
+        });
+
+        measure("rect/union", [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i++)
+                _sink = rect::union_(a, b).w;
+        });
+
+        measure("rect/contains", [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i++)
+                _sink = a.contains(p);
+        });
+    }
+
+    void bench_surface() {
+        surface dest(640, 480, 32);
+        surface src(256, 256, 32);
+        src.fill(200, 100, 50);
+
+        measure("surface/fill", [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i++)
+                dest.fill(color {static_cast<std::uint8_t>(i), 0, 0, 255});
+        });
+
+        measure("surface/fill_rect", [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i++)
+                dest.fill_rect(rect {64, 64, 128, 128}, 0, static_cast<std::uint8_t>(i), 0);
+        });
+
+        measure("surface/blit", [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i++)
+                src.blit(dest);
+        });
+
+        measure("surface/blit_scaled", [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i++)
+                src.blit_scaled(dest);
+        });
+    }
+
+    void bench_renderer(window& win) {
+        renderer& r = win.get_renderer();
+
+        surface surf(64, 64, 32);
+        surf.fill(30, 120, 220);
+        static_texture tex(r, surf);
+
+        rect src {0, 0, 64, 64};
+
+        measure("renderer/fill_rect", [&](std::uint64_t n) {
+            r.set_color(255, 0, 0, 255);
+            for (std::uint64_t i = 0; i < n; i++)
+                r.fill_rect(rect {static_cast<int>(i % 500), 100, 64, 64});
+        });
+
+        measure("texture/render", [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i++)
+                tex.render(src, rect {static_cast<int>(i % 500), 200, 64, 64});
+        });
+
+        // a frame of 256 textured quads, cleared and presented
+        measure("renderer/frame", [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i++) {
+                r.clear();
+                for (int q = 0; q < 256; q++)
+                    tex.render(src, rect {(q % 16) * 40, (q / 16) * 30, 64, 64});
+                r.present();
+            }
+        });
+    }
+
+#ifdef WSDL2_TTF
+    void bench_ttf() {
+        const char *path = std::getenv("WSDL2_BENCH_FONT");
+        if (path == NULL) {
+            std::cerr << "WSDL2_BENCH_FONT is not set, skipping ttf\n";
+            return;
+        }
+
+        ttf::font f(path, 16);
+        const std::string text = "The quick brown fox jumps over the lazy dog";
+        const color fg {255, 255, 255, 255};
+
+        measure("ttf/text_size", [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i++)
+                _sink = f.text_size(text)->first;
+        });
+
+        measure("ttf/render_solid", [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i++)
+                _sink = f.render_text_solid(text, fg)->width();
+        });
+
+        measure("ttf/render_blended", [&](std::uint64_t n) {
+            for (std::uint64_t i = 0; i < n; i++)
+                _sink = f.render_text_blended(text, fg)->width();
+        });
+    }
+#endif
+
+    void push_motion(unsigned window_id, std::uint64_t n) {
+        SDL_Event ev;
+        SDL_zero(ev);
+        ev.type = SDL_MOUSEMOTION;
+        ev.motion.windowID = window_id;
+
+        for (std::uint64_t i = 0; i < n; i++) {
+            ev.motion.x = static_cast<Sint32>(i % 640);
+            SDL_PushEvent(&ev);
+        }
+    }
+
+    void bench_events(window& win) {
+        // the SDL queue holds a limited number of events
+        constexpr std::uint64_t chunk = 4096;
+
+        measure("event/poll", [&](std::uint64_t n) {
+            for (std::uint64_t done = 0; done < n; done += chunk) {
+                push_motion(win.id(), std::min(chunk, n - done));
+                while (event::poll())
+                    ;
+            }
+        });
+
+        measure("event/route", [&](std::uint64_t n) {
+            for (std::uint64_t done = 0; done < n; done += chunk) {
+                push_motion(win.id(), std::min(chunk, n - done));
+                event::route();
+                while (win.poll())
+                    ;
+            }
+        });
+    }
+}
+
+int main(int argc, char *argv[]) {
+    // do not overwrite a driver chosen by the user
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+
+    if (!wsdl2::initialize()) {
+        std::cerr << "failed to initialize SDL: " << SDL_GetError() << "\n";
+        return 1;
+    }
+
+    std::string driver, renderer_name;
+
+    {
+        // measure throughput, not the display refresh rate
+        renderer_config config;
+        config.drivers = {"software"};
+        config.type = renderer_config::backend::software;
+        config.vsync = false;
+
+        auto win = std::make_unique<window>("wsdl2 bench", 640, 480, config);
+        renderer_name = win->get_renderer().info().name;
+
+        if (const char *d = SDL_GetCurrentVideoDriver())
+            driver = d;
+
+        bench_rect();
+        bench_surface();
+        bench_renderer(*win);
+#ifdef WSDL2_TTF
+        bench_ttf();
+#endif
+        bench_events(*win);
+    }
+
+    wsdl2::quit();
+
+    if (argc > 1) {
+        std::ofstream out(argv[1]);
+        if (!out) {
+            std::cerr << "cannot write " << argv[1] << "\n";
+            return 1;
+        }
+
+        write_json(out, driver, renderer_name);
+    } else {
+        write_json(std::cout, driver, renderer_name);
+    }
+
+    return 0;
+}
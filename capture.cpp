@@ -0,0 +1,260 @@
+#ifdef WSDL2_THREADS
+
+#include "wsdl2/capture.hpp"
+#include "wsdl2/debug.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+extern "C" {
+#include <SDL2/SDL.h>
+}
+
+using namespace wsdl2;
+
+recorder::recorder(const std::string& path, output o,
+    std::size_t buffers /* = 4 */, int fps /* = 60 */)
+    : m_path(path), m_output(o), m_fps(fps)
+{
+    if (m_output != output::screenshots) {
+        m_stream.open(m_path, std::ios::binary);
+        if (!m_stream) {
+            throw std::runtime_error("failed to open " + m_path);
+        }
+    }
+
+    for (std::size_t i = 0; i < std::max<std::size_t>(buffers, 1); i++)
+        m_free.push_back(std::make_unique<frame>());
+
+    m_thread = std::thread(&recorder::loop, this);
+    npdebug("started recorder");
+}
+
+recorder::~recorder() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+
+    m_cv.notify_all();
+    m_thread.join();
+
+    wsdl2_log(info, "recorded ", m_written.load(), " of ",
+        m_captured.load(), " frames, dropped ", m_dropped.load());
+}
+
+std::unique_ptr<recorder::frame> recorder::acquire(int width, int height) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const std::uint64_t index = m_captured++;
+
+    if (m_output != output::screenshots) {
+        if (m_width == 0) {
+            m_width = width;
+            m_height = height;
+        }
+
+        if (width != m_width || height != m_height) {
+            m_dropped++;
+            wsdl2_log(warn, "frame ", index, " is ", width, "x", height,
+                ", the stream is ", m_width, "x", m_height);
+            return nullptr;
+        }
+    }
+
+    if (m_free.empty()) {
+        m_dropped++;
+        npdebug("dropped frame ", index, ", the recorder is behind");
+        return nullptr;
+    }
+
+    std::unique_ptr<frame> f = std::move(m_free.back());
+    m_free.pop_back();
+    f->index = index;
+    f->width = width;
+    f->height = height;
+    f->pixels.resize(static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 4);
+
+    return f;
+}
+
+void recorder::release(std::unique_ptr<frame> f) {
+    m_dropped++;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_free.push_back(std::move(f));
+}
+
+void recorder::submit(std::unique_ptr<frame> f) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(std::move(f));
+    }
+
+    m_cv.notify_one();
+}
+
+void recorder::loop() {
+    for (;;) {
+        std::unique_ptr<frame> f;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return !m_queue.empty() || !m_running; });
+
+            if (m_queue.empty())
+                break;
+
+            f = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+
+        if (write(*f))
+            m_written++;
+        else
+            m_dropped++;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_free.push_back(std::move(f));
+    }
+
+    m_stream.flush();
+}
+
+bool recorder::write(const frame& f) {
+    if (m_output == output::screenshots)
+        return write_bmp(f);
+
+    // every frame has the size of the first one (see acquire())
+    if (!m_header) {
+        m_header = true;
+
+        if (m_output == output::y4m) {
+            m_stream << "YUV4MPEG2 W" << f.width << " H" << f.height
+                     << " F" << m_fps << ":1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n";
+        }
+    }
+
+    if (m_output == output::y4m)
+        return write_y4m(f);
+
+    m_stream.write(reinterpret_cast<const char *>(f.pixels.data()),
+        static_cast<std::streamsize>(f.pixels.size()));
+
+    return static_cast<bool>(m_stream);
+}
+
+bool recorder::write_bmp(const frame& f) {
+    SDL_Surface *surf = SDL_CreateRGBSurfaceWithFormatFrom(
+        const_cast<std::uint8_t *>(f.pixels.data()), f.width, f.height,
+        32, f.width * 4, SDL_PIXELFORMAT_BGRA32
+    );
+
+    if (!util::check(surf != NULL))
+        return false;
+
+    const std::string path = m_path + std::to_string(f.index) + ".bmp";
+    const bool ok = util::check(0 == SDL_SaveBMP(surf, path.c_str()));
+
+    SDL_FreeSurface(surf);
+    return ok;
+}
+
+bool recorder::write_y4m(const frame& f) {
+    const std::size_t w = static_cast<std::size_t>(f.width);
+    const std::size_t h = static_cast<std::size_t>(f.height);
+    const std::size_t cw = (w + 1) / 2;
+    const std::size_t ch = (h + 1) / 2;
+
+    m_yuv.resize(w * h + 2 * cw * ch);
+    std::uint8_t *y_plane = m_yuv.data();
+    std::uint8_t *u_plane = y_plane + w * h;
+    std::uint8_t *v_plane = u_plane + cw * ch;
+
+    // full range BT.601, as tagged in the header
+    const std::uint8_t *px = f.pixels.data();
+    for (std::size_t y = 0; y < h; y++) {
+        for (std::size_t x = 0; x < w; x++) {
+            const std::uint8_t *p = px + (y * w + x) * 4;
+            const int b = p[0], g = p[1], r = p[2];
+
+            y_plane[y * w + x] = static_cast<std::uint8_t>(
+                (77 * r + 150 * g + 29 * b + 128) >> 8);
+        }
+    }
+
+    // chroma of the average of each 2x2 block, smaller on odd edges
+    for (std::size_t cy = 0; cy < ch; cy++) {
+        for (std::size_t cx = 0; cx < cw; cx++) {
+            int r = 0, g = 0, b = 0, n = 0;
+
+            for (std::size_t y = 2 * cy; y < std::min(2 * cy + 2, h); y++) {
+                for (std::size_t x = 2 * cx; x < std::min(2 * cx + 2, w); x++) {
+                    const std::uint8_t *p = px + (y * w + x) * 4;
+                    b += p[0];
+                    g += p[1];
+                    r += p[2];
+                    n++;
+                }
+            }
+
+            r = (r + n / 2) / n;
+            g = (g + n / 2) / n;
+            b = (b + n / 2) / n;
+
+            const std::size_t c = cy * cw + cx;
+            u_plane[c] = static_cast<std::uint8_t>(std::clamp(
+                ((-43 * r - 85 * g + 128 * b + 128) >> 8) + 128, 0, 255));
+            v_plane[c] = static_cast<std::uint8_t>(std::clamp(
+                ((128 * r - 107 * g - 21 * b + 128) >> 8) + 128, 0, 255));
+        }
+    }
+
+    m_stream << "FRAME\n";
+    m_stream.write(reinterpret_cast<const char *>(m_yuv.data()),
+        static_cast<std::streamsize>(m_yuv.size()));
+
+    return static_cast<bool>(m_stream);
+}
+
+bool renderer::capture(recorder& rec) {
+    wsdl2_profile_zone("renderer::capture");
+
+    // SDL reads the viewport in output pixels, which differ from its
+    // logical size with a render scale, a logical size or high-DPI
+    SDL_Rect view;
+    float sx = 1.0f, sy = 1.0f;
+    int out_w = 0, out_h = 0;
+
+    SDL_RenderGetViewport(sdl(), &view);
+    SDL_RenderGetScale(sdl(), &sx, &sy);
+
+    if (!util::check(0 == SDL_GetRendererOutputSize(sdl(), &out_w, &out_h)))
+        return false;
+
+    const rect pixels {
+        static_cast<int>(static_cast<float>(view.x) * sx + 0.5f),
+        static_cast<int>(static_cast<float>(view.y) * sy + 0.5f),
+        static_cast<int>(static_cast<float>(view.w) * sx + 0.5f),
+        static_cast<int>(static_cast<float>(view.h) * sy + 0.5f)
+    };
+
+    const auto area = pixels.intersection(rect {0, 0, out_w, out_h});
+    if (!area)
+        return false;
+
+    std::unique_ptr<recorder::frame> f = rec.acquire(area->w, area->h);
+    if (!f)
+        return false;
+
+    // an explicit rect, SDL never reads more than it into the buffer
+    if (!util::check(0 == SDL_RenderReadPixels(sdl(), &*area, SDL_PIXELFORMAT_BGRA32,
+            f->pixels.data(), area->w * 4)))
+    {
+        rec.release(std::move(f));
+        return false;
+    }
+
+    rec.submit(std::move(f));
+    return true;
+}
+
+#endif
@@ -1,4 +1,11 @@
 #include "wsdl2/event.hpp"
+#include "wsdl2/video.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 using namespace wsdl2::event;
 
@@ -68,3 +75,124 @@ using namespace wsdl2::event;
         return std::nullopt;
     }
 */
+
+// events that are not addressed to a window, filled by route()
+static std::deque<SDL_Event> _global_events;
+
+void wsdl2::event::route() {
+    SDL_Event ev;
+
+    while (SDL_PollEvent(&ev) != 0) {
+        std::uint32_t id = window_id(ev);
+
+        if (id != 0) {
+            if (wsdl2::window *w = wsdl2::window::find(id)) {
+                w->m_events.push_back(ev);
+                continue;
+            }
+        }
+
+        _global_events.push_back(ev);
+    }
+}
+
+std::optional<any> wsdl2::event::poll_global() {
+    while (!_global_events.empty()) {
+        SDL_Event ev = _global_events.front();
+        _global_events.pop_front();
+
+        if (auto e = translate(ev))
+            return e;
+    }
+
+    return std::nullopt;
+}
+
+/* event filters */
+
+// filters are called by SDL from whichever thread pushes the event;
+// the list is replaced rather than modified, so that it is called without
+// the lock held and a filter can add filters or push events
+using filter_list = std::vector<std::pair<std::uint32_t, filter>>;
+
+static std::mutex _filters_mutex;
+static std::shared_ptr<const filter_list> _filters = std::make_shared<filter_list>();
+
+static int run_filters(void *, SDL_Event *ev) {
+    std::shared_ptr<const filter_list> filters;
+    {
+        std::lock_guard<std::mutex> lock(_filters_mutex);
+        filters = _filters;
+    }
+
+    for (const auto& [type, f] : *filters) {
+        if (type == ev->type && !f(*ev))
+            return 0;
+    }
+
+    return 1;
+}
+
+void wsdl2::event::add_filter(std::uint32_t sdl_type, filter f) {
+    bool install;
+    {
+        std::lock_guard<std::mutex> lock(_filters_mutex);
+        install = _filters->empty();
+
+        auto filters = std::make_shared<filter_list>(*_filters);
+        filters->emplace_back(sdl_type, std::move(f));
+        _filters = std::move(filters);
+    }
+
+    if (install)
+        SDL_SetEventFilter(run_filters, nullptr);
+
+    // events already in the queue should obey the new filter too
+    SDL_FilterEvents(run_filters, nullptr);
+}
+
+void wsdl2::event::clear_filters(std::uint32_t sdl_type) {
+    bool uninstall;
+    {
+        std::lock_guard<std::mutex> lock(_filters_mutex);
+
+        auto filters = std::make_shared<filter_list>(*_filters);
+        filters->erase(std::remove_if(filters->begin(), filters->end(),
+            [sdl_type](const auto& entry) { return entry.first == sdl_type; }),
+            filters->end()
+        );
+
+        uninstall = filters->empty();
+        _filters = std::move(filters);
+    }
+
+    if (uninstall)
+        SDL_SetEventFilter(nullptr, nullptr);
+}
+
+void wsdl2::event::clear_filters() {
+    SDL_SetEventFilter(nullptr, nullptr);
+
+    std::lock_guard<std::mutex> lock(_filters_mutex);
+    _filters = std::make_shared<filter_list>();
+}
+
+/* class watch */
+
+watch::watch(callback c) : m_callback(new callback(std::move(c))) {
+    SDL_AddEventWatch(trampoline, m_callback.get());
+}
+
+watch::watch(watch&& other) : m_callback(std::move(other.m_callback)) {}
+
+watch::~watch() {
+    if (m_callback) {
+        SDL_DelEventWatch(trampoline, m_callback.get());
+    }
+}
+
+int watch::trampoline(void *userdata, SDL_Event *ev) {
+    (*static_cast<callback*>(userdata))(*ev);
+    // the return value of watches is ignored by SDL
+    return 0;
+}
@@ -0,0 +1,241 @@
+#include "wsdl2/event_stream.hpp"
+
+#include <limits>
+
+using namespace wsdl2::event;
+
+kind wsdl2::event::kind_of(std::uint32_t sdl_type) {
+    if (sdl_type >= SDL_USEREVENT && sdl_type <= SDL_LASTEVENT)
+        return kind::user;
+
+    switch (sdl_type) {
+    // application
+    case SDL_QUIT:                      return kind::quit;
+    case SDL_APP_TERMINATING:           return kind::app_terminating;
+    case SDL_APP_LOWMEMORY:             return kind::app_low_memory;
+    case SDL_APP_WILLENTERBACKGROUND:   return kind::app_will_enter_background;
+    case SDL_APP_DIDENTERBACKGROUND:    return kind::app_did_enter_background;
+    case SDL_APP_WILLENTERFOREGROUND:   return kind::app_will_enter_foreground;
+    case SDL_APP_DIDENTERFOREGROUND:    return kind::app_did_enter_foreground;
+#if SDL_VERSION_ATLEAST(2, 0, 14)
+    case SDL_LOCALECHANGED:             return kind::locale_changed;
+#endif
+
+    // display and window
+#if SDL_VERSION_ATLEAST(2, 0, 9)
+    case SDL_DISPLAYEVENT:              return kind::display;
+#endif
+    case SDL_WINDOWEVENT:               return kind::window;
+    case SDL_SYSWMEVENT:                return kind::syswm;
+
+    // keyboard
+    case SDL_KEYDOWN:                   return kind::key_down;
+    case SDL_KEYUP:                     return kind::key_up;
+    case SDL_TEXTEDITING:               return kind::text_editing;
+    case SDL_TEXTINPUT:                 return kind::text_input;
+    case SDL_KEYMAPCHANGED:             return kind::keymap_changed;
+
+    // mouse
+    case SDL_MOUSEMOTION:               return kind::mouse_motion;
+    case SDL_MOUSEBUTTONDOWN:           return kind::mouse_button_down;
+    case SDL_MOUSEBUTTONUP:             return kind::mouse_button_up;
+    case SDL_MOUSEWHEEL:                return kind::mouse_wheel;
+
+    // joystick
+    case SDL_JOYAXISMOTION:             return kind::joy_axis;
+    case SDL_JOYBALLMOTION:             return kind::joy_ball;
+    case SDL_JOYHATMOTION:              return kind::joy_hat;
+    case SDL_JOYBUTTONDOWN:             return kind::joy_button_down;
+    case SDL_JOYBUTTONUP:               return kind::joy_button_up;
+    case SDL_JOYDEVICEADDED:            return kind::joy_device_added;
+    case SDL_JOYDEVICEREMOVED:          return kind::joy_device_removed;
+
+    // game controller
+    case SDL_CONTROLLERAXISMOTION:      return kind::controller_axis;
+    case SDL_CONTROLLERBUTTONDOWN:      return kind::controller_button_down;
+    case SDL_CONTROLLERBUTTONUP:        return kind::controller_button_up;
+    case SDL_CONTROLLERDEVICEADDED:     return kind::controller_device_added;
+    case SDL_CONTROLLERDEVICEREMOVED:   return kind::controller_device_removed;
+    case SDL_CONTROLLERDEVICEREMAPPED:  return kind::controller_device_remapped;
+
+    // touch and gestures
+    case SDL_FINGERDOWN:                return kind::finger_down;
+    case SDL_FINGERUP:                  return kind::finger_up;
+    case SDL_FINGERMOTION:              return kind::finger_motion;
+    case SDL_DOLLARGESTURE:             return kind::dollar_gesture;
+    case SDL_DOLLARRECORD:              return kind::dollar_record;
+    case SDL_MULTIGESTURE:              return kind::multi_gesture;
+
+    // clipboard and drag and drop
+    case SDL_CLIPBOARDUPDATE:           return kind::clipboard_update;
+    case SDL_DROPFILE:                  return kind::drop_file;
+    case SDL_DROPTEXT:                  return kind::drop_text;
+    case SDL_DROPBEGIN:                 return kind::drop_begin;
+    case SDL_DROPCOMPLETE:              return kind::drop_complete;
+
+    // devices
+    case SDL_AUDIODEVICEADDED:          return kind::audio_device_added;
+    case SDL_AUDIODEVICEREMOVED:        return kind::audio_device_removed;
+#if SDL_VERSION_ATLEAST(2, 0, 9)
+    case SDL_SENSORUPDATE:              return kind::sensor_update;
+#endif
+
+    // render
+    case SDL_RENDER_TARGETS_RESET:      return kind::render_targets_reset;
+    case SDL_RENDER_DEVICE_RESET:       return kind::render_device_reset;
+
+    default:
+        return kind::unknown;
+    }
+}
+
+std::size_t wsdl2::event::payload_size(kind k) {
+    switch (k) {
+    case kind::quit:
+        return sizeof(SDL_QuitEvent);
+
+    case kind::app_terminating: [[fallthrough]];
+    case kind::app_low_memory: [[fallthrough]];
+    case kind::app_will_enter_background: [[fallthrough]];
+    case kind::app_did_enter_background: [[fallthrough]];
+    case kind::app_will_enter_foreground: [[fallthrough]];
+    case kind::app_did_enter_foreground: [[fallthrough]];
+    case kind::locale_changed: [[fallthrough]];
+    case kind::keymap_changed: [[fallthrough]];
+    case kind::clipboard_update: [[fallthrough]];
+    case kind::render_targets_reset: [[fallthrough]];
+    case kind::render_device_reset:
+        return sizeof(SDL_CommonEvent);
+
+#if SDL_VERSION_ATLEAST(2, 0, 9)
+    case kind::display:
+        return sizeof(SDL_DisplayEvent);
+#endif
+
+    case kind::window:
+        return sizeof(SDL_WindowEvent);
+
+    case kind::syswm:
+        return sizeof(SDL_SysWMEvent);
+
+    case kind::key_down: [[fallthrough]];
+    case kind::key_up:
+        return sizeof(SDL_KeyboardEvent);
+
+    case kind::text_editing:
+        return sizeof(SDL_TextEditingEvent);
+
+    case kind::text_input:
+        return sizeof(SDL_TextInputEvent);
+
+    case kind::mouse_motion:
+        return sizeof(SDL_MouseMotionEvent);
+
+    case kind::mouse_button_down: [[fallthrough]];
+    case kind::mouse_button_up:
+        return sizeof(SDL_MouseButtonEvent);
+
+    case kind::mouse_wheel:
+        return sizeof(SDL_MouseWheelEvent);
+
+    case kind::joy_axis:
+        return sizeof(SDL_JoyAxisEvent);
+
+    case kind::joy_ball:
+        return sizeof(SDL_JoyBallEvent);
+
+    case kind::joy_hat:
+        return sizeof(SDL_JoyHatEvent);
+
+    case kind::joy_button_down: [[fallthrough]];
+    case kind::joy_button_up:
+        return sizeof(SDL_JoyButtonEvent);
+
+    case kind::joy_device_added: [[fallthrough]];
+    case kind::joy_device_removed:
+        return sizeof(SDL_JoyDeviceEvent);
+
+    case kind::controller_axis:
+        return sizeof(SDL_ControllerAxisEvent);
+
+    case kind::controller_button_down: [[fallthrough]];
+    case kind::controller_button_up:
+        return sizeof(SDL_ControllerButtonEvent);
+
+    case kind::controller_device_added: [[fallthrough]];
+    case kind::controller_device_removed: [[fallthrough]];
+    case kind::controller_device_remapped:
+        return sizeof(SDL_ControllerDeviceEvent);
+
+    case kind::finger_down: [[fallthrough]];
+    case kind::finger_up: [[fallthrough]];
+    case kind::finger_motion:
+        return sizeof(SDL_TouchFingerEvent);
+
+    case kind::dollar_gesture: [[fallthrough]];
+    case kind::dollar_record:
+        return sizeof(SDL_DollarGestureEvent);
+
+    case kind::multi_gesture:
+        return sizeof(SDL_MultiGestureEvent);
+
+    // NOTE: the stream does not own the string of drop_file and
+    // drop_text, it still has to be released with SDL_free()
+    case kind::drop_file: [[fallthrough]];
+    case kind::drop_text: [[fallthrough]];
+    case kind::drop_begin: [[fallthrough]];
+    case kind::drop_complete:
+        return sizeof(SDL_DropEvent);
+
+    case kind::audio_device_added: [[fallthrough]];
+    case kind::audio_device_removed:
+        return sizeof(SDL_AudioDeviceEvent);
+
+#if SDL_VERSION_ATLEAST(2, 0, 9)
+    case kind::sensor_update:
+        return sizeof(SDL_SensorEvent);
+#endif
+
+    case kind::user:
+        return sizeof(SDL_UserEvent);
+
+    case kind::unknown: [[fallthrough]];
+    default:
+        return sizeof(SDL_Event);
+    }
+}
+
+static_assert(sizeof(SDL_Event) <= std::numeric_limits<std::uint16_t>::max());
+
+void stream::push(const SDL_Event& ev) {
+    const kind k = kind_of(ev.type);
+    const std::size_t size = payload_size(k);
+
+    const std::size_t pos = m_buffer.size();
+    m_buffer.resize(pos + 1 + words(size));
+
+    m_buffer[pos] = static_cast<word>(k) | static_cast<word>(size << 16);
+    std::memcpy(&m_buffer[pos + 1], &ev, size);
+
+    m_count++;
+}
+
+std::size_t stream::pump() {
+    SDL_Event ev;
+    std::size_t count = 0;
+
+    while (SDL_PollEvent(&ev) != 0) {
+        push(ev);
+        count++;
+    }
+
+    return count;
+}
+
+SDL_Event stream::record::sdl() const {
+    SDL_Event ev;
+    std::memset(&ev, 0, sizeof(SDL_Event));
+    std::memcpy(&ev, data(), size());
+
+    return ev;
+}
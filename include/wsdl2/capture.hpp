@@ -0,0 +1,107 @@
+#pragma once
+
+/* wsdl2 frame capture header
+ *
+ * renderer::capture() reads back the current render target into one of
+ * a fixed pool of buffers and hands it to a recorder, whose thread
+ * converts and writes it. When the writer falls behind and every buffer
+ * is in use the frame is dropped instead of stalling the render loop.
+ *
+ */
+
+#ifndef WSDL2_THREADS
+#warning "libwrapsdl2 is complied without support for threads"
+#endif
+
+#ifdef WSDL2_THREADS
+#include "wsdl2/video.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace wsdl2 {
+
+    /// writes captured frames on its own thread
+    class recorder {
+    public:
+        friend class renderer;
+
+        enum class output {
+            // one bitmap per frame, named path + frame number + ".bmp"
+            screenshots,
+            // B, G, R, A bytes of every frame appended to a single file
+            raw,
+            // YUV 4:2:0 stream, playable by ffmpeg, mpv, ...
+            y4m,
+        };
+
+        /// buffers: frames that can wait to be written before dropping
+        recorder(const std::string& path, output o,
+                 std::size_t buffers = 4, int fps = 60);
+        recorder(const recorder& other) = delete;
+
+        /// writes the frames still queued
+        ~recorder();
+
+        /// frames handed over by renderer::capture()
+        inline std::uint64_t captured() const { return m_captured; }
+        inline std::uint64_t written() const { return m_written; }
+        /// frames lost because no buffer was free or writing failed
+        inline std::uint64_t dropped() const { return m_dropped; }
+
+    private:
+        struct frame {
+            std::vector<std::uint8_t> pixels;
+            int width = 0;
+            int height = 0;
+            std::uint64_t index = 0;
+        };
+
+        const std::string m_path;
+        const output m_output;
+        const int m_fps;
+
+        std::ofstream m_stream;
+        std::vector<std::uint8_t> m_yuv;
+        bool m_header = false;
+
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::vector<std::unique_ptr<frame>> m_free;
+        std::deque<std::unique_ptr<frame>> m_queue;
+        bool m_running = true;
+
+        // stream outputs need every frame to have the same size, set by
+        // the first capture
+        int m_width = 0;
+        int m_height = 0;
+
+        std::atomic<std::uint64_t> m_captured {0};
+        std::atomic<std::uint64_t> m_written {0};
+        std::atomic<std::uint64_t> m_dropped {0};
+
+        std::thread m_thread;
+
+        /// a free buffer for a frame of that size, nullptr (and a dropped
+        /// frame) if there is none or the size does not fit the stream
+        std::unique_ptr<frame> acquire(int width, int height);
+        /// give back a buffer that could not be filled
+        void release(std::unique_ptr<frame> f);
+        void submit(std::unique_ptr<frame> f);
+
+        void loop();
+        bool write(const frame& f);
+        bool write_bmp(const frame& f);
+        bool write_y4m(const frame& f);
+    };
+}
+
+#endif
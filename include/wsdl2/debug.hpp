@@ -3,30 +3,19 @@
 #ifndef __NPDEBUG__
 #define __NPDEBUG__
 
+#include "log.hpp"
+
 #include <iostream>
 #include <sstream>
 
 #ifndef NDEBUG
-    #define __FILENAME__ (\
-        __builtin_strrchr(__FILE__, '/') ? \
-        __builtin_strrchr(__FILE__, '/') + 1 : __FILE__)
-
-    #define npdebug_prep(); { \
-            std::cerr << "[" << __FILENAME__ \
-                      << ":" << __LINE__ \
-                      << ", " << __func__ \
-                      << "] " ; \
-    }
-
-    #define npdebug(...); { \
-        npdebug_prep(); \
-        np::va_debug(__VA_ARGS__); \
-    }
+    // debug messages go through the asynchronous logger
+    #define npdebug(...) wsdl2_log(debug, __VA_ARGS__)
 
     namespace np {
         template<typename... Args>
         inline void va_debug(Args&&... args) {
-            (std::cerr << ... << args) << std::endl;
+            npdebug(std::forward<Args>(args)...);
         }
 
         template<typename T>
@@ -56,7 +45,7 @@
         }
     }
 #else
-    #define npdebug(...) {}
+    #define npdebug(...) do {} while (0)
 
     namespace np {
         template<typename... Args>
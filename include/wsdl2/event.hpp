@@ -4,8 +4,15 @@
 #include "mm/mmvec.hpp"
 #endif 
 
+#include <algorithm>
+#include <chrono>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <limits>
 #include <memory>
 #include <optional>
+#include <stdexcept>
 #include <variant>
 
 #ifdef DEBUG
@@ -15,6 +22,8 @@
 #ifndef __WSDL_EVENT_H__
 #define __WSDL_EVENT_H__
 
+#include "profile.hpp"
+
 extern "C" {
 #include <SDL2/SDL_events.h>
 }
@@ -182,16 +191,13 @@ namespace wsdl2::event {
             std::int32_t  xrel;
             std::int32_t  yrel;
 
-            // TODO: make helpers to read MASKS
-            // SDL_BUTTON_LMASK
-            // SDL_BUTTON_MMASK
-            // SDL_BUTTON_RMASK
-            // SDL_BUTTON_X1MASK
-            // SDL_BUTTON_X2MASK
-            // void was_pressed(wsdl2::button b);
-
             motion() = delete;
 
+            /// whether a button was held down during the motion
+            inline bool was_pressed(wsdl2::button b) const {
+                return (__state & SDL_BUTTON(static_cast<std::uint32_t>(b))) != 0;
+            }
+
             static inline motion from_event(const SDL_Event& e) {
                 static_assert(sizeof(motion) == sizeof(SDL_MouseMotionEvent));
                 static_assert(alignof(motion) == alignof(SDL_MouseMotionEvent));
@@ -281,6 +287,8 @@ namespace wsdl2::event {
                 std::uint32_t window_id;
                 action        __action;
 
+                static constexpr action event_action = Action;
+
                 partial() = delete;
                 static inline Derived from_event(const SDL_Event& e) {
                     // TODO: fix these checks
@@ -305,7 +313,7 @@ namespace wsdl2::event {
 
         struct shown : helper::dataless<shown, action::shown> {};
         struct hidden : helper::dataless<hidden, action::hidden> {};
-        struct exposed : helper::dataless<hidden, action::exposed> {};
+        struct exposed : helper::dataless<exposed, action::exposed> {};
 
         struct moved : helper::partial<moved, action::moved> {
             std::int32_t  x;
@@ -318,9 +326,8 @@ namespace wsdl2::event {
         };
     }
 
-    // this function cannot be placed inside the cpp because of some
-    // weird template shit
-    inline std::optional<std::variant<
+    /// any event that wsdl2 knows how to translate
+    using any = std::variant<
         // quit event
         quit,
         // keyboard events
@@ -335,54 +342,284 @@ namespace wsdl2::event {
         window::exposed,
         window::moved,
         window::resized
-    >> poll() {
+    >;
+
+    /// convert a raw SDL_Event, unhandled events become nullopt
+    inline std::optional<any> translate(const SDL_Event& ev) {
+        switch (ev.type) {
+        // keyboard events
+        case SDL_KEYUP: [[fallthrough]];
+        case SDL_KEYDOWN:
+            return key::from_event(ev);
+
+        // mouse events
+        case SDL_MOUSEBUTTONDOWN: [[fallthrough]];
+        case SDL_MOUSEBUTTONUP:
+            return mouse::button::from_event(ev);
+
+        case SDL_MOUSEMOTION:
+            return mouse::motion::from_event(ev);
+            
+        case SDL_MOUSEWHEEL:
+            return mouse::wheel::from_event(ev);
+ 
+        // sdl quit event
+        case SDL_QUIT:
+            return quit::from_event(ev);
+ 
+        // window events
+        case SDL_WINDOWEVENT:
+            switch (ev.window.event) {
+            case SDL_WINDOWEVENT_SHOWN:
+                return window::shown::from_event(ev);
+
+            case SDL_WINDOWEVENT_HIDDEN:
+                return window::hidden::from_event(ev);
+
+            case SDL_WINDOWEVENT_EXPOSED:
+                return window::exposed::from_event(ev);
+                
+            case SDL_WINDOWEVENT_MOVED:
+                return window::moved::from_event(ev);
+
+            case SDL_WINDOWEVENT_RESIZED:
+                return window::resized::from_event(ev);
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    namespace helper {
+        /// SDL event types that are translated into T
+        template<typename T, typename = void>
+        struct sdl_types;
+
+        template<>
+        struct sdl_types<quit> {
+            static constexpr std::array<std::uint32_t, 1> value { SDL_QUIT };
+        };
+
+        template<>
+        struct sdl_types<key> {
+            static constexpr std::array<std::uint32_t, 2> value {
+                SDL_KEYDOWN, SDL_KEYUP
+            };
+        };
+
+        template<>
+        struct sdl_types<mouse::button> {
+            static constexpr std::array<std::uint32_t, 2> value {
+                SDL_MOUSEBUTTONDOWN, SDL_MOUSEBUTTONUP
+            };
+        };
+
+        template<>
+        struct sdl_types<mouse::motion> {
+            static constexpr std::array<std::uint32_t, 1> value { SDL_MOUSEMOTION };
+        };
+
+        template<>
+        struct sdl_types<mouse::wheel> {
+            static constexpr std::array<std::uint32_t, 1> value { SDL_MOUSEWHEEL };
+        };
+
+        /// all window events share SDL_WINDOWEVENT
+        template<typename T>
+        struct sdl_types<T, std::void_t<decltype(T::event_action)>> {
+            static constexpr std::array<std::uint32_t, 1> value { SDL_WINDOWEVENT };
+        };
+
+        template<typename T, typename = void>
+        struct is_window_event : std::false_type {};
+
+        template<typename T>
+        struct is_window_event<T, std::void_t<decltype(T::event_action)>>
+            : std::true_type {};
+    }
+
+    /* source-side filtering, events rejected by a filter never enter
+     * SDL's queue. Filters can be called from the thread that pushes the
+     * event, and wsdl2 owns SDL_SetEventFilter while any filter is set.
+     */
+
+    /// return false to drop the event
+    using filter = std::function<bool(const SDL_Event&)>;
+
+    /// add a filter for one SDL event type, an event is kept only if
+    /// all the filters for its type accept it
+    void add_filter(std::uint32_t sdl_type, filter f);
+
+    template<typename T>
+    void add_filter(std::function<bool(const T&)> f) {
+        for (std::uint32_t type : helper::sdl_types<T>::value) {
+            add_filter(type, [f](const SDL_Event& ev) {
+                if constexpr (helper::is_window_event<T>::value) {
+                    // let other window events through
+                    if (static_cast<window::action>(ev.window.event)
+                            != T::event_action)
+                        return true;
+                }
+
+                return f(T::from_event(ev));
+            });
+        }
+    }
+
+    void clear_filters(std::uint32_t sdl_type);
+    void clear_filters();
+
+    /// sees every event that enters the queue but cannot drop it,
+    /// removed when destroyed
+    class watch {
+    public:
+        using callback = std::function<void(const SDL_Event&)>;
+
+        watch() = delete;
+        watch(const watch& other) = delete;
+
+        watch(callback c);
+        watch(watch&& other);
+        ~watch();
+
+    private:
+        std::unique_ptr<callback> m_callback;
+
+        static int trampoline(void *userdata, SDL_Event *ev);
+    };
+
+    /// disabled event types are dropped by SDL without being queued
+    inline void enable(std::uint32_t sdl_type, bool enabled = true) {
+        SDL_EventState(sdl_type, enabled ? SDL_ENABLE : SDL_DISABLE);
+    }
+
+    inline void disable(std::uint32_t sdl_type) {
+        enable(sdl_type, false);
+    }
+
+    inline bool is_enabled(std::uint32_t sdl_type) {
+        return SDL_EventState(sdl_type, SDL_QUERY) == SDL_ENABLE;
+    }
+
+    template<typename T>
+    inline void enable(bool enabled = true) {
+        static_assert(!helper::is_window_event<T>::value,
+            "window events share one SDL type, use add_filter instead");
+
+        for (std::uint32_t type : helper::sdl_types<T>::value)
+            enable(type, enabled);
+    }
+
+    template<typename T>
+    inline void disable() {
+        enable<T>(false);
+    }
+
+    /// id of the window an event is addressed to, 0 if there is none
+    inline std::uint32_t window_id(const SDL_Event& ev) {
+        switch (ev.type) {
+        case SDL_WINDOWEVENT:
+            return ev.window.windowID;
+
+        case SDL_KEYDOWN: [[fallthrough]];
+        case SDL_KEYUP:
+            return ev.key.windowID;
+
+        case SDL_TEXTEDITING:
+            return ev.edit.windowID;
+
+        case SDL_TEXTINPUT:
+            return ev.text.windowID;
+
+        case SDL_MOUSEMOTION:
+            return ev.motion.windowID;
+
+        case SDL_MOUSEBUTTONDOWN: [[fallthrough]];
+        case SDL_MOUSEBUTTONUP:
+            return ev.button.windowID;
+
+        case SDL_MOUSEWHEEL:
+            return ev.wheel.windowID;
+
+        case SDL_DROPFILE: [[fallthrough]];
+        case SDL_DROPTEXT: [[fallthrough]];
+        case SDL_DROPBEGIN: [[fallthrough]];
+        case SDL_DROPCOMPLETE:
+            return ev.drop.windowID;
+
+        default:
+            return 0;
+        }
+    }
+
+    /// drain the SDL queue once, events addressed to a window are moved
+    /// into that window's queue (see window::poll()), everything else
+    /// is kept for poll_global()
+    void route();
+
+    /// next routed event that is not addressed to any window
+    std::optional<any> poll_global();
+
+    // this function cannot be placed inside the cpp because of some
+    // weird template shit
+    inline std::optional<any> poll() {
+        wsdl2_profile_zone("event::poll");
         SDL_Event ev;
         
         if (SDL_PollEvent(&ev) != 0) {
-            switch (ev.type) {
-            // keyboard events
-            case SDL_KEYUP: [[fallthrough]];
-            case SDL_KEYDOWN:
-                return key::from_event(ev);
-
-            // mouse events
-            case SDL_MOUSEBUTTONDOWN: [[fallthrough]];
-            case SDL_MOUSEBUTTONUP:
-                return mouse::button::from_event(ev);
-
-            case SDL_MOUSEMOTION:
-                return mouse::motion::from_event(ev);
-                
-            case SDL_MOUSEWHEEL:
-                return mouse::wheel::from_event(ev);
-     
-            // sdl quit event
-            case SDL_QUIT:
-                return quit::from_event(ev);
-     
-            // window events
-            case SDL_WINDOWEVENT:
-                switch (ev.window.event) {
-                case SDL_WINDOWEVENT_SHOWN:
-                    return window::shown::from_event(ev);
-
-                case SDL_WINDOWEVENT_HIDDEN:
-                    return window::hidden::from_event(ev);
-
-                case SDL_WINDOWEVENT_EXPOSED:
-                    return window::exposed::from_event(ev);
-                    
-                case SDL_WINDOWEVENT_MOVED:
-                    return window::moved::from_event(ev);
-
-                case SDL_WINDOWEVENT_RESIZED:
-                    return window::resized::from_event(ev);
-                }
-            }
+            return translate(ev);
         }
 
         return std::nullopt;
     }
+
+    using clock = std::chrono::steady_clock;
+
+    /// block until an event arrives or the deadline has passed,
+    /// returns nullopt once the deadline is reached, even if events are
+    /// still queued (they are left for the next call or poll())
+    inline std::optional<any> wait_until(clock::time_point deadline) {
+        SDL_Event ev;
+
+        for (;;) {
+            // checked on every event, a steady stream of events must not
+            // keep the caller past the deadline
+            auto now = clock::now();
+            if (now >= deadline)
+                return std::nullopt;
+
+            // round up, waking up early would make the caller spin
+            auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
+            int timeout = static_cast<int>(std::min<std::chrono::milliseconds::rep>(
+                left.count(), std::numeric_limits<int>::max()
+            ));
+
+            // skip events that we cannot translate and keep waiting
+            if (SDL_WaitEventTimeout(&ev, timeout) != 0) {
+                if (auto e = translate(ev))
+                    return e;
+            }
+        }
+    }
+
+    template<typename Rep, typename Period>
+    inline std::optional<any> wait_for(std::chrono::duration<Rep, Period> timeout) {
+        return wait_until(clock::now()
+            + std::chrono::duration_cast<clock::duration>(timeout));
+    }
+
+    /// block until an event arrives
+    inline any wait() {
+        SDL_Event ev;
+
+        for (;;) {
+            if (SDL_WaitEvent(&ev) == 0)
+                throw std::runtime_error("failed to wait for SDL events");
+
+            if (auto e = translate(ev))
+                return *e;
+        }
+    }
 }
 
 #endif
@@ -0,0 +1,238 @@
+#pragma once
+
+/* wsdl2 packed event stream header
+ *
+ * Stores SDL events back to back in a single buffer, each record is a
+ * 4 byte header (small type tag + payload size) followed by the SDL
+ * structure of that event type only, instead of the whole SDL_Event
+ * union. Every SDL event type is kept, those that wsdl2 does not know
+ * are stored as a full SDL_Event.
+ *
+ */
+
+#include "event.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <vector>
+
+extern "C" {
+#include <SDL2/SDL_events.h>
+#include <SDL2/SDL_version.h>
+}
+
+namespace wsdl2::event {
+
+    enum class kind : std::uint16_t {
+        unknown = 0,
+
+        // application
+        quit,
+        app_terminating,
+        app_low_memory,
+        app_will_enter_background,
+        app_did_enter_background,
+        app_will_enter_foreground,
+        app_did_enter_foreground,
+        locale_changed,
+
+        // display and window
+        display,
+        window,
+        syswm,
+
+        // keyboard
+        key_down,
+        key_up,
+        text_editing,
+        text_input,
+        keymap_changed,
+
+        // mouse
+        mouse_motion,
+        mouse_button_down,
+        mouse_button_up,
+        mouse_wheel,
+
+        // joystick
+        joy_axis,
+        joy_ball,
+        joy_hat,
+        joy_button_down,
+        joy_button_up,
+        joy_device_added,
+        joy_device_removed,
+
+        // game controller
+        controller_axis,
+        controller_button_down,
+        controller_button_up,
+        controller_device_added,
+        controller_device_removed,
+        controller_device_remapped,
+
+        // touch and gestures
+        finger_down,
+        finger_up,
+        finger_motion,
+        dollar_gesture,
+        dollar_record,
+        multi_gesture,
+
+        // clipboard and drag and drop
+        clipboard_update,
+        drop_file,
+        drop_text,
+        drop_begin,
+        drop_complete,
+
+        // devices
+        audio_device_added,
+        audio_device_removed,
+        sensor_update,
+
+        // render
+        render_targets_reset,
+        render_device_reset,
+
+        // SDL_USEREVENT up to SDL_LASTEVENT
+        user,
+    };
+
+    /// tag of an SDL event type and the size of its payload
+    kind kind_of(std::uint32_t sdl_type);
+    std::size_t payload_size(kind k);
+
+    class stream {
+    public:
+        using word = std::uint32_t;
+
+        /// view of a single event inside the stream, does not own data
+        class record {
+        public:
+            record(const word *head) : m_head(head) {}
+
+            inline kind type() const {
+                return static_cast<kind>(*m_head & 0xffff);
+            }
+
+            inline std::size_t size() const { return *m_head >> 16; }
+            inline const void * data() const { return m_head + 1; }
+
+            /// every SDL event structure starts with type and timestamp
+            inline std::uint32_t sdl_type() const { return m_head[1]; }
+            inline std::uint32_t timestamp() const { return m_head[2]; }
+
+            /// zero-copy access to the payload
+            template<typename T>
+            inline const T& as() const {
+                static_assert(alignof(T) <= alignof(word),
+                    "payload is not aligned for this type, use copy<T>()");
+#ifdef DEBUG
+                assert(sizeof(T) <= size());
+#endif
+                return *reinterpret_cast<const T*>(data());
+            }
+
+            /// copy out the payload, works for any alignment
+            template<typename T>
+            inline T copy() const {
+                T t;
+#ifdef DEBUG
+                assert(sizeof(T) <= size());
+#endif
+                std::memcpy(&t, data(), sizeof(T));
+                return t;
+            }
+
+            /// rebuild the original SDL event
+            SDL_Event sdl() const;
+
+            /// convert to the wsdl2 event types (see event::translate)
+            inline std::optional<any> translate() const {
+                return wsdl2::event::translate(sdl());
+            }
+
+        private:
+            const word *m_head;
+        };
+
+        class iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = record;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const record*;
+            using reference = record;
+
+            iterator(const word *pos) : m_pos(pos) {}
+
+            inline record operator*() const { return record(m_pos); }
+
+            inline iterator& operator++() {
+                m_pos += 1 + words(*m_pos >> 16);
+                return *this;
+            }
+
+            inline iterator operator++(int) {
+                iterator old = *this;
+                ++(*this);
+                return old;
+            }
+
+            inline bool operator==(const iterator& other) const {
+                return m_pos == other.m_pos;
+            }
+
+            inline bool operator!=(const iterator& other) const {
+                return m_pos != other.m_pos;
+            }
+
+        private:
+            const word *m_pos;
+        };
+
+        stream() = default;
+
+        /// append an event
+        void push(const SDL_Event& ev);
+
+        /// drain SDL's queue into the stream, returns the number of events
+        std::size_t pump();
+
+        inline iterator begin() const { return iterator(m_buffer.data()); }
+        inline iterator end() const {
+            return iterator(m_buffer.data() + m_buffer.size());
+        }
+
+        /// number of events
+        inline std::size_t size() const { return m_count; }
+        inline bool empty() const { return m_count == 0; }
+
+        /// memory used by the events
+        inline std::size_t bytes() const { return m_buffer.size() * sizeof(word); }
+
+        inline void reserve(std::size_t bytes) {
+            m_buffer.reserve(words(bytes));
+        }
+
+        /// keeps the allocated memory
+        inline void clear() {
+            m_buffer.clear();
+            m_count = 0;
+        }
+
+        /// raw access, to store or send the stream somewhere else
+        inline const word * data() const { return m_buffer.data(); }
+
+    private:
+        std::vector<word> m_buffer;
+        std::size_t m_count = 0;
+
+        static constexpr std::size_t words(std::size_t bytes) {
+            return (bytes + sizeof(word) - 1) / sizeof(word);
+        }
+    };
+}
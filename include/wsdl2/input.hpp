@@ -0,0 +1,88 @@
+#pragma once
+
+/* wsdl2 input snapshot header
+ *
+ * Instead of tracking every key and button event, take a snapshot of
+ * the keyboard and mouse once per frame and query it with bit tests.
+ *
+ */
+
+#include "event.hpp"
+#include "video.hpp"
+
+#include <array>
+#include <cstdint>
+
+extern "C" {
+#include <SDL2/SDL_keyboard.h>
+#include <SDL2/SDL_mouse.h>
+}
+
+namespace wsdl2 {
+
+    class input_state {
+    public:
+        using scancode = SDL_Scancode;
+
+        input_state() = default;
+
+        /// take a new snapshot, call once per frame after the events
+        /// have been pumped (event::poll(), event::route(), ...)
+        void update();
+
+        /// keyboard, by physical key
+        inline bool down(scancode k) const { return test(m_down, k); }
+        inline bool pressed(scancode k) const { return test(m_pressed, k); }
+        inline bool released(scancode k) const { return test(m_released, k); }
+
+        /// mouse buttons
+        inline bool down(wsdl2::button b) const {
+            return test(m_buttons, b);
+        }
+
+        inline bool pressed(wsdl2::button b) const {
+            return test(m_buttons_pressed, b);
+        }
+
+        inline bool released(wsdl2::button b) const {
+            return test(m_buttons_released, b);
+        }
+
+        /// mouse position relative to the focused window
+        inline point mouse() const { return m_mouse; }
+
+        /// mouse movement since the previous snapshot
+        inline point mouse_delta() const { return m_mouse_delta; }
+
+    private:
+        static constexpr std::size_t words = (SDL_NUM_SCANCODES + 63) / 64;
+        using bitset = std::array<std::uint64_t, words>;
+
+        bitset m_down {};
+        bitset m_pressed {};
+        bitset m_released {};
+
+        std::uint32_t m_buttons = 0;
+        std::uint32_t m_buttons_pressed = 0;
+        std::uint32_t m_buttons_released = 0;
+
+        point m_mouse {0, 0};
+        point m_mouse_delta {0, 0};
+
+        // no previous position to move from before the first snapshot
+        bool m_first = true;
+
+        static inline bool test(const bitset& bits, scancode k) {
+            const auto i = static_cast<std::uint32_t>(k);
+            // invalid scancodes are never down
+            if (i >= SDL_NUM_SCANCODES)
+                return false;
+
+            return (bits[i >> 6] >> (i & 63)) & 1;
+        }
+
+        static inline bool test(std::uint32_t mask, wsdl2::button b) {
+            return (mask >> (static_cast<std::uint32_t>(b) - 1)) & 1;
+        }
+    };
+}
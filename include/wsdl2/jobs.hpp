@@ -0,0 +1,74 @@
+#pragma once
+
+/* wsdl2 job system header
+ *
+ * A small work-stealing thread pool shared by the library and its users
+ * for CPU-side graphics work (decoding, text rasterization, pixel
+ * conversion). It is started by wsdl2::initialize() and stopped by
+ * wsdl2::quit().
+ *
+ */
+
+#ifndef WSDL2_THREADS
+#warning "libwrapsdl2 is complied without support for threads"
+#endif
+
+#ifdef WSDL2_THREADS
+#include "wsdl2/video.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+namespace wsdl2::jobs {
+
+    /// which threads may run a job
+    enum class affinity {
+        any,
+        // only in run_pending(affinity::main), the thread that called start()
+        main,
+        // only on the render thread (see render_thread)
+        render,
+    };
+
+    struct job;
+    using handle = std::shared_ptr<job>;
+
+    /// start the workers, 0 means one per core minus the calling thread
+    void start(unsigned workers = 0);
+
+    /// finish the queued jobs and join the workers
+    void stop();
+
+    unsigned worker_count();
+
+    /// schedule f once all the dependencies have completed
+    handle submit(std::function<void()> f,
+                  std::initializer_list<handle> deps = {},
+                  affinity a = affinity::any);
+
+    handle submit(std::function<void()> f,
+                  const std::vector<handle>& deps,
+                  affinity a = affinity::any);
+
+    bool done(const handle& h);
+
+    /// block until the job has completed, runs other jobs meanwhile;
+    /// rethrows the exception that escaped the job, if any
+    void wait(const handle& h);
+    /// waits for every job before rethrowing the first exception
+    void wait(const std::vector<handle>& hs);
+
+    /// run the jobs pinned to the calling thread, returns how many ran
+    std::size_t run_pending(affinity a);
+
+    /// call f(first, last) on chunks of [begin, end) and wait for them
+    void parallel_for(std::size_t begin, std::size_t end, std::size_t grain,
+                      const std::function<void(std::size_t, std::size_t)>& f);
+
+    // parallel_rows() is declared in video.hpp
+}
+
+#endif
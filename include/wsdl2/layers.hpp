@@ -0,0 +1,99 @@
+#pragma once
+
+/* wsdl2 layers header
+ *
+ * Retained rendering: every layer draws its content into its own
+ * target_texture only when it has been invalidated, and the compositor
+ * draws all the textures every frame, ordered by z, at their position
+ * and with their alpha.
+ *
+ */
+
+#include "wsdl2/video.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace wsdl2 {
+
+    class layer {
+    public:
+        friend class compositor;
+
+        /// draws the content, the layer is the current target and cleared
+        using painter = std::function<void(renderer&)>;
+
+        layer(renderer& r, int width, int height, painter p);
+        layer(const layer& other) = delete;
+
+        /// the content will be redrawn before the next composition
+        inline void invalidate() { m_dirty = true; }
+        inline bool dirty() const { return m_dirty; }
+
+        /// replace what the layer draws, invalidates it
+        inline void paint_with(painter p) {
+            m_paint = std::move(p);
+            m_dirty = true;
+        }
+
+        // placement, these do not need a redraw
+        inline point position() const { return m_position; }
+        inline void position(const point& p) { m_position = p; }
+
+        inline std::uint8_t alpha() const { return m_alpha; }
+        inline void alpha(std::uint8_t a) { m_alpha = a; }
+
+        inline int z() const { return m_z; }
+        inline void z(int order) { m_z = order; }
+
+        inline bool visible() const { return m_visible; }
+        inline void visible(bool show) { m_visible = show; }
+
+        inline int width() const { return m_texture.width(); }
+        inline int height() const { return m_texture.height(); }
+
+        /// redraw now if invalidated, leaves the layer as render target
+        void update();
+
+        /// draw onto the current target
+        void render();
+
+    private:
+        renderer& m_renderer;
+        target_texture m_texture;
+        painter m_paint;
+
+        point m_position {0, 0};
+        std::uint8_t m_alpha = 255;
+        int m_z = 0;
+        bool m_visible = true;
+        bool m_dirty = true;
+    };
+
+    /// owns layers and draws them in order
+    class compositor {
+    public:
+        compositor(renderer& r) : m_renderer(r) {}
+        compositor(const compositor& other) = delete;
+
+        /// the returned reference is valid until the layer is removed
+        layer& add(int width, int height, layer::painter p, int z = 0);
+        void remove(const layer& l);
+        void clear() { m_layers.clear(); }
+
+        void invalidate_all();
+
+        /// redraw the invalidated layers, then draw every visible layer
+        /// by ascending z (in order of insertion for the same z) onto
+        /// the target that was current when called
+        void render();
+
+        inline std::size_t size() const { return m_layers.size(); }
+
+    private:
+        renderer& m_renderer;
+        std::vector<std::unique_ptr<layer>> m_layers;
+    };
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+/* wsdl2 logging header
+ *
+ * Leveled logging with the level fixed at compile time: a disabled
+ * wsdl2_log() call does not evaluate nor format its arguments. Enabled
+ * messages are formatted by the calling thread into its own lock-free
+ * ring buffer and written out by a background thread, so logging never
+ * waits on the terminal.
+ *
+ * WSDL2_LOG_LEVEL selects the lowest level that is compiled in, it
+ * defaults to debug, or to info when NDEBUG is defined.
+ *
+ */
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+#define WSDL2_LOG_TRACE 0
+#define WSDL2_LOG_DEBUG 1
+#define WSDL2_LOG_INFO  2
+#define WSDL2_LOG_WARN  3
+#define WSDL2_LOG_ERROR 4
+#define WSDL2_LOG_OFF   5
+
+#ifndef WSDL2_LOG_LEVEL
+    #ifdef NDEBUG
+        #define WSDL2_LOG_LEVEL WSDL2_LOG_INFO
+    #else
+        #define WSDL2_LOG_LEVEL WSDL2_LOG_DEBUG
+    #endif
+#endif
+
+#ifndef __FILENAME__
+    #define __FILENAME__ (\
+        __builtin_strrchr(__FILE__, '/') ? \
+        __builtin_strrchr(__FILE__, '/') + 1 : __FILE__)
+#endif
+
+/// usage: wsdl2_log(warn, "texture ", name, " is too large");
+#define wsdl2_log(lvl, ...) do { \
+    if constexpr (::wsdl2::log::enabled(::wsdl2::log::level::lvl)) { \
+        ::wsdl2::log::write(::wsdl2::log::level::lvl, \
+            __FILENAME__, __LINE__, __func__, __VA_ARGS__); \
+    } \
+} while (0)
+
+namespace wsdl2::log {
+    enum class level : int {
+        trace = WSDL2_LOG_TRACE,
+        debug = WSDL2_LOG_DEBUG,
+        info  = WSDL2_LOG_INFO,
+        warn  = WSDL2_LOG_WARN,
+        error = WSDL2_LOG_ERROR,
+        off   = WSDL2_LOG_OFF,
+    };
+
+    constexpr bool enabled(level l) {
+        return l != level::off && static_cast<int>(l) >= WSDL2_LOG_LEVEL;
+    }
+
+    /// queue an already formatted message
+    void submit(level l, const char *file, int line, const char *func,
+                const std::string& msg);
+
+    template<typename... Args>
+    inline void write(level l, const char *file, int line, const char *func,
+                      Args&&... args)
+    {
+        // reuse the stream of this thread
+        thread_local std::ostringstream ss;
+        ss.str("");
+        ss.clear();
+
+        (ss << ... << args);
+        submit(l, file, line, func, ss.str());
+    }
+
+    /// block until every message queued so far has been written
+    void flush();
+
+    /// write out the queued messages and join the writer thread, called
+    /// by wsdl2::quit(); later messages are written by the logging thread
+    void stop();
+
+    /// messages lost because a thread's buffer was full
+    std::uint64_t dropped();
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+/* wsdl2 particles header
+ *
+ * Emitters keep their particles as a structure of arrays: one float
+ * array per component, so that the update is a few loops over
+ * contiguous memory the compiler can vectorize. All the particles of an
+ * emitter are drawn with its texture in a single geometry call.
+ *
+ */
+
+#include "wsdl2/video.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace wsdl2 {
+
+    class emitter {
+    public:
+        /// spread values are the maximum random deviation, in both directions
+        struct settings {
+            // particles per second, emitted by update()
+            float rate = 100.0f;
+
+            // in seconds
+            float lifetime = 1.0f;
+            float lifetime_spread = 0.0f;
+
+            // in pixels per second, angles in radians (0 points right)
+            float speed = 100.0f;
+            float speed_spread = 0.0f;
+            float angle = 0.0f;
+            float angle_spread = 3.14159265f;
+
+            // acceleration in pixels per second squared
+            float gravity_x = 0.0f;
+            float gravity_y = 0.0f;
+
+            // interpolated over the lifetime of a particle
+            float size_start = 8.0f;
+            float size_end = 8.0f;
+            color color_start {255, 255, 255, 255};
+            color color_end {255, 255, 255, 0};
+        };
+
+        /// the texture must outlive the emitter, capacity is the maximum
+        /// number of particles alive at once
+        emitter(renderer& r, texture& t, std::size_t capacity);
+        emitter(renderer& r, texture& t, std::size_t capacity, const settings& s);
+        emitter(const emitter& other) = delete;
+
+        inline settings& config() { return m_settings; }
+        inline const settings& config() const { return m_settings; }
+
+        inline void position(float x, float y) {
+            m_x = x;
+            m_y = y;
+        }
+
+        /// stop or resume the emission at settings::rate
+        inline void active(bool enable) { m_active = enable; }
+        inline bool active() const { return m_active; }
+
+        /// emit up to n particles at once, returns how many fitted
+        std::size_t burst(std::size_t n);
+
+        /// emit, move and expire the particles; with parallel the movement
+        /// is split among the job workers when there are enough of them
+        void update(float dt, bool parallel = false);
+
+        /// one geometry call for the whole emitter
+        void render();
+
+        inline std::size_t size() const { return m_count; }
+        inline std::size_t capacity() const { return m_capacity; }
+
+        void clear();
+
+    private:
+        renderer& m_renderer;
+        texture& m_texture;
+        settings m_settings;
+
+        const std::size_t m_capacity;
+        std::size_t m_count = 0;
+
+        float m_x = 0.0f;
+        float m_y = 0.0f;
+        bool m_active = true;
+
+        // fraction of a particle left by the previous update
+        float m_pending = 0.0f;
+
+        // components, the first m_count elements are alive
+        std::vector<float> m_px, m_py;
+        std::vector<float> m_vx, m_vy;
+        std::vector<float> m_age, m_life;
+
+        std::minstd_rand m_random;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        // rebuilt every render(), the indices only when the count grows
+        std::vector<vertex> m_vertices;
+        std::vector<int> m_indices;
+#endif
+
+        void spawn(std::size_t n);
+        void integrate(std::size_t first, std::size_t last, float dt);
+        void expire();
+    };
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+/* wsdl2 profiling header
+ *
+ * Scoped timing zones recorded into per-thread ring buffers and dumped
+ * in the Chrome trace event format (chrome://tracing, Perfetto).
+ * Zones compile to nothing unless WSDL2_PROFILE is defined.
+ *
+ */
+
+#ifdef WSDL2_PROFILE
+#include "wsdl2/timing.hpp"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#define __WSDL2_CONCAT_IMPL(a, b) a##b
+#define __WSDL2_CONCAT(a, b) __WSDL2_CONCAT_IMPL(a, b)
+
+/// time the rest of the scope, name must be a string literal
+#define wsdl2_profile_zone(name) \
+    ::wsdl2::profile::zone __WSDL2_CONCAT(__wsdl2_zone_, __LINE__)(name)
+
+namespace wsdl2::profile {
+    /// store a completed zone in the buffer of the calling thread
+    void record(const char *name, std::uint64_t begin, std::uint64_t end);
+
+    class zone {
+    public:
+        zone() = delete;
+        zone(const zone& other) = delete;
+
+        inline zone(const char *name) : m_name(name), m_begin(timing::now()) {}
+        inline ~zone() { record(m_name, m_begin, timing::now()); }
+
+    private:
+        const char *m_name;
+        const std::uint64_t m_begin;
+    };
+
+    /// write every recorded zone as chrome trace json, zones that are
+    /// recorded while writing may or may not be included
+    void write_chrome_trace(std::ostream& out);
+    bool write_chrome_trace(const std::string& path);
+
+    /// forget the recorded zones, and the buffers of exited threads
+    void clear();
+}
+
+#else
+#define wsdl2_profile_zone(name)
+#endif
@@ -0,0 +1,213 @@
+#pragma once
+
+/* wsdl2 render thread header
+ *
+ * SDL renderers may only be used by one thread. This header lets any
+ * thread record draw commands into its own command_buffer, while a
+ * dedicated thread owns the renderer, merges the buffers submitted for
+ * a frame, executes them and presents.
+ *
+ */
+
+#ifndef WSDL2_THREADS
+#warning "libwrapsdl2 is complied without support for threads"
+#endif
+
+#ifdef WSDL2_THREADS
+#include "wsdl2/util.hpp"
+#include "wsdl2/video.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <variant>
+#include <vector>
+
+namespace wsdl2 {
+
+    class render_thread;
+
+    /// handle to a texture that lives on the render thread
+    class texture_proxy {
+    public:
+        friend class render_thread;
+
+        texture_proxy() = default;
+
+        /// false until the render thread has created the texture
+        inline bool ready() const {
+            return m_state && m_state->ready.load(std::memory_order_acquire);
+        }
+        inline explicit operator bool() const { return static_cast<bool>(m_state); }
+
+    private:
+        struct state {
+            // tex is written by the render thread only, ready tells the
+            // other threads when it has been created
+            std::atomic<bool> ready {false};
+            std::unique_ptr<texture> tex;
+            std::optional<surface> source;
+            int width = 0;
+            int height = 0;
+        };
+
+        std::shared_ptr<state> m_state;
+
+        texture_proxy(std::shared_ptr<state> s) : m_state(std::move(s)) {}
+    };
+
+    /// draw commands recorded on any thread, mirrors the renderer API
+    class command_buffer {
+    public:
+        friend class render_thread;
+
+        command_buffer() = default;
+        command_buffer(command_buffer&& other) = default;
+        command_buffer& operator=(command_buffer&& other) = default;
+
+        inline void set_color(const color& c) { m_commands.emplace_back(cmd::color {c}); }
+        inline void set_color(std::uint8_t r, std::uint8_t g, std::uint8_t b, std::uint8_t a) {
+            set_color(color {r, g, b, a});
+        }
+
+        inline void clear() { m_commands.emplace_back(cmd::clear {}); }
+
+        inline void viewport(const rect& v) { m_commands.emplace_back(cmd::viewport {v}); }
+        inline void reset_viewport() { m_commands.emplace_back(cmd::viewport {}); }
+
+        /// target must be a target texture, an empty proxy resets the target
+        inline void set_target(const texture_proxy& t) {
+            m_commands.emplace_back(cmd::target {t});
+        }
+
+        inline void draw_point(const point& p) { m_commands.emplace_back(cmd::point {p}); }
+        inline void draw_line(const point& a, const point& b) {
+            m_commands.emplace_back(cmd::line {a, b});
+        }
+
+        inline void draw_rect(const rect& r) { m_commands.emplace_back(cmd::rect {r, false}); }
+        inline void fill_rect(const rect& r) { m_commands.emplace_back(cmd::rect {r, true}); }
+
+        inline void render(const texture_proxy& t) {
+            m_commands.emplace_back(cmd::copy {t, std::nullopt, std::nullopt});
+        }
+
+        inline void render(const texture_proxy& t, const rect& src, const rect& dest) {
+            m_commands.emplace_back(cmd::copy {t, src, dest});
+        }
+
+        inline void render(const texture_proxy& t, const rect& src, const rect& dest,
+            double angle, const point& center, renderer::flip flip)
+        {
+            m_commands.emplace_back(cmd::copy_ex {t, src, dest, angle, center, flip});
+        }
+
+        /// escape hatch, runs on the render thread
+        inline void call(std::function<void(renderer&)> f) {
+            m_commands.emplace_back(cmd::call {std::move(f)});
+        }
+
+        inline std::size_t size() const { return m_commands.size(); }
+        inline bool empty() const { return m_commands.empty(); }
+
+    private:
+        struct cmd {
+            struct color { wsdl2::color c; };
+            struct clear {};
+            struct viewport { std::optional<wsdl2::rect> v; };
+            struct target { texture_proxy t; };
+            struct point { wsdl2::point p; };
+            struct line { wsdl2::point a, b; };
+            struct rect { wsdl2::rect r; bool fill; };
+            struct copy {
+                texture_proxy t;
+                std::optional<wsdl2::rect> src, dest;
+            };
+            struct copy_ex {
+                texture_proxy t;
+                wsdl2::rect src, dest;
+                double angle;
+                wsdl2::point center;
+                renderer::flip flip;
+            };
+            struct call { std::function<void(renderer&)> f; };
+        };
+
+        using command = std::variant<
+            cmd::color, cmd::clear, cmd::viewport, cmd::target,
+            cmd::point, cmd::line, cmd::rect,
+            cmd::copy, cmd::copy_ex, cmd::call
+        >;
+
+        std::vector<command> m_commands;
+    };
+
+    /// owns the renderer of a window on a dedicated thread
+    class render_thread {
+    public:
+        /* SDL renderers must be used by the thread that created them, so
+         * the renderer of the window is destroyed and created again by the
+         * render thread; from now on draw only through this object, which
+         * must be destroyed before the window. When destroyed it creates
+         * a renderer for the window again on the calling thread
+         */
+        render_thread(window& w, const renderer_config& config = renderer_config());
+        render_thread(const render_thread& other) = delete;
+        ~render_thread();
+
+        /// queue a buffer for the current frame, buffers are executed
+        /// by ascending layer and then in order of submission
+        void submit(command_buffer&& cmds, int layer = 0);
+
+        /// hand the frame to the render thread, blocks only while the
+        /// previous frame is still being rendered
+        void end_frame();
+
+        /// block until every frame handed over has been presented
+        void flush();
+
+        /// textures are created on the render thread before the next frame
+        texture_proxy create_texture(surface&& surf);
+        texture_proxy create_target(int width, int height);
+
+    private:
+        struct frame {
+            std::vector<std::pair<int, command_buffer>> buffers;
+            std::vector<std::shared_ptr<texture_proxy::state>> uploads;
+        };
+
+        window& m_window;
+        const renderer_config m_config;
+
+        // created and destroyed by the render thread
+        std::unique_ptr<renderer> m_renderer;
+
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+
+        // frame being recorded and frame waiting for the render thread
+        frame m_recording;
+        std::optional<frame> m_pending;
+        bool m_busy = false;
+        bool m_running = true;
+        bool m_started = false;
+        std::exception_ptr m_error;
+
+        // textures are destroyed on the render thread when unused
+        std::vector<std::shared_ptr<texture_proxy::state>> m_textures;
+
+        std::thread m_thread;
+
+        void loop();
+        void execute(frame& f);
+        void collect();
+        void rethrow();
+    };
+}
+
+#endif
@@ -0,0 +1,108 @@
+#pragma once
+
+/* wsdl2 shapes header
+ *
+ * Circles, polygons and thick polylines tessellated into triangles and
+ * drawn with a single geometry call each. The triangles are cached in
+ * local coordinates by the parameters of the shape, so that a shape
+ * drawn again unchanged, even elsewhere, costs only its submission.
+ * Requires SDL 2.0.18, with older versions there are no shapes.
+ *
+ */
+
+#include "wsdl2/video.hpp"
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace wsdl2 {
+
+    using fpoint = SDL_FPoint;
+
+    class shapes {
+    public:
+        /// how two segments of a thick line are connected
+        enum class join {
+            // sharp corner, beveled when the tip is more than twice the
+            // thickness away from it
+            miter,
+            bevel,
+            round,
+        };
+
+        /// capacity is the number of tessellations kept
+        shapes(renderer& r, std::size_t capacity = 256);
+        shapes(const shapes& other) = delete;
+
+        void fill_circle(const fpoint& center, float radius, const color& c);
+        void draw_circle(const fpoint& center, float radius, float thickness, const color& c);
+
+        /// any simple polygon, convex or concave, in either winding order
+        void fill_polygon(const std::vector<fpoint>& points, const color& c);
+        void draw_polygon(const std::vector<fpoint>& points, float thickness, const color& c,
+                          join j = join::miter);
+
+        /// segments have flat ends; translucent lines blend twice where
+        /// the segments overlap on the inner side of a join
+        void draw_polyline(const std::vector<fpoint>& points, float thickness, const color& c,
+                           join j = join::miter);
+
+        /// drop every cached tessellation
+        void clear();
+
+        inline std::size_t size() const { return m_cache.size(); }
+
+        /// shapes drawn from the cache and tessellated since creation
+        inline std::uint64_t hits() const { return m_hits; }
+        inline std::uint64_t misses() const { return m_misses; }
+
+    private:
+        struct mesh {
+            std::vector<vertex> vertices;
+            std::vector<int> indices;
+        };
+
+        struct entry {
+            std::uint64_t hash;
+            std::vector<float> key;
+            mesh m;
+        };
+
+        renderer& m_renderer;
+        const std::size_t m_capacity;
+
+        // most recently used first, the map points into the list
+        std::list<entry> m_cache;
+        std::unordered_map<std::uint64_t, std::list<entry>::iterator> m_index;
+
+        // parameters of the shape being drawn, and its points relative
+        // to the first one
+        std::vector<float> m_key;
+        std::vector<fpoint> m_local;
+
+        // vertices of the mesh being submitted, moved into place
+        std::vector<vertex> m_placed;
+
+        std::uint64_t m_hits = 0;
+        std::uint64_t m_misses = 0;
+
+        void begin_key(int kind, const color& c, std::initializer_list<float> params);
+        /// add the points relative to the first one, which is the origin
+        const std::vector<fpoint>& add_key(const std::vector<fpoint>& points, fpoint& origin);
+
+        /// the cached mesh of m_key, or an empty one to fill when fresh
+        mesh& fetch(bool& fresh);
+        void submit(const mesh& m, const fpoint& origin);
+
+        void stroke(const std::vector<fpoint>& points, float thickness, const color& c,
+                    join j, bool closed);
+    };
+}
+
+#endif
@@ -0,0 +1,116 @@
+#pragma once
+
+/* wsdl2 tilemap header
+ *
+ * A grid of tile ids drawn from an atlas texture. The map is split into
+ * square chunks that are baked into target textures the first time they
+ * are visible and again only after one of their tiles has changed, so
+ * a frame costs one copy per visible chunk instead of one per tile.
+ * Chunks without any tile are never baked, the baked ones are kept up
+ * to a memory budget and the least recently drawn are dropped first.
+ *
+ */
+
+#include "wsdl2/video.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <vector>
+
+namespace wsdl2 {
+
+    class tilemap {
+    public:
+        /// index of a cell of the atlas, counted left to right, top to bottom
+        using tile = std::uint16_t;
+        static constexpr tile empty = 0xffff;
+
+        /// the atlas must outlive the map, chunk_size is in tiles;
+        /// memory_budget (in bytes) bounds the baked chunks, it should fit
+        /// the chunks visible at once
+        tilemap(renderer& r, texture& atlas, int tile_width, int tile_height,
+                int columns, int rows, int chunk_size = 16,
+                std::size_t memory_budget = 64 << 20);
+        tilemap(const tilemap& other) = delete;
+
+        inline int columns() const { return m_columns; }
+        inline int rows() const { return m_rows; }
+
+        inline tile at(int x, int y) const {
+            return m_tiles[static_cast<std::size_t>(y * m_columns + x)];
+        }
+
+        /// marks the chunk of the tile to be baked again
+        void set(int x, int y, tile t);
+        void fill(tile t);
+
+        /// row major, see set() and invalidate() to modify it
+        inline const std::vector<tile>& tiles() const { return m_tiles; }
+
+        /// bake every chunk again, e.g. after the atlas has changed
+        void invalidate();
+
+        /// draw the chunks that intersect the viewport, camera is the map
+        /// pixel shown at the top left corner of the viewport; the map is
+        /// drawn onto the current target
+        void render(const point& camera);
+
+        /// chunks drawn by the last render()
+        inline std::size_t drawn() const { return m_drawn; }
+        /// chunks not drawn by the last render() because the budget was
+        /// used up by the visible ones
+        inline std::size_t missing() const { return m_missing; }
+        /// chunks baked into a texture
+        inline std::size_t cached() const { return m_baked.size(); }
+
+    private:
+        struct chunk {
+            std::unique_ptr<target_texture> tex;
+            bool dirty = true;
+
+            // tiles that are not empty
+            int filled = 0;
+
+            // last render() that drew it, and its place in m_baked
+            std::uint64_t frame = 0;
+            std::list<std::size_t>::iterator lru;
+        };
+
+        renderer& m_renderer;
+        texture& m_atlas;
+
+        const int m_tile_width;
+        const int m_tile_height;
+        const int m_columns;
+        const int m_rows;
+        const int m_chunk_size;
+        const std::size_t m_capacity;
+
+        // chunks per row and per column
+        const int m_chunk_columns;
+        const int m_chunk_rows;
+
+        std::vector<tile> m_tiles;
+        std::vector<chunk> m_chunks;
+
+        // indices of the chunks with a texture, most recently drawn first
+        std::list<std::size_t> m_baked;
+        std::uint64_t m_frame = 0;
+
+        std::size_t m_drawn = 0;
+        std::size_t m_missing = 0;
+
+        inline chunk& chunk_at(int cx, int cy) {
+            return m_chunks[static_cast<std::size_t>(cy * m_chunk_columns + cx)];
+        }
+
+        /// size in pixels, chunks on the right and bottom edges are smaller
+        point chunk_size(int cx, int cy) const;
+
+        /// false if every texture the budget allows is drawn this frame
+        bool bake(int cx, int cy);
+        void release(chunk& c);
+    };
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+/* wsdl2 timing header
+ *
+ * High resolution frame pacing on top of SDL_GetPerformanceCounter,
+ * with a fixed simulation timestep and jitter statistics.
+ *
+ */
+
+#include <cstdint>
+
+extern "C" {
+#include <SDL2/SDL_timer.h>
+}
+
+namespace wsdl2 {
+
+    namespace timing {
+        /// raw performance counter ticks
+        inline std::uint64_t now() { return SDL_GetPerformanceCounter(); }
+        inline std::uint64_t frequency() { return SDL_GetPerformanceFrequency(); }
+
+        inline double seconds(std::uint64_t ticks) {
+            return static_cast<double>(ticks) / static_cast<double>(frequency());
+        }
+
+        inline std::uint64_t ticks(double seconds) {
+            return static_cast<std::uint64_t>(seconds * static_cast<double>(frequency()));
+        }
+
+        /// sleep with SDL_Delay for most of the time and spin on the
+        /// counter for the rest, to wake up at a precise time
+        void sleep_until(std::uint64_t deadline, double spin = 0.002);
+    }
+
+    class frame_clock {
+    public:
+        /// measured time between frames, in seconds
+        struct stats {
+            std::uint64_t frames = 0;
+            // frames that ended after their deadline
+            std::uint64_t missed = 0;
+
+            double mean = 0;
+            double min = 0;
+            double max = 0;
+            // standard deviation of the frame time
+            double jitter = 0;
+        };
+
+        /// fps: presentation rate, step_rate: simulation updates per second
+        frame_clock(double fps, double step_rate);
+        explicit frame_clock(double fps) : frame_clock(fps, fps) {}
+
+        /// start a new frame, feeds the elapsed time to the simulation
+        void tick();
+
+        /// fixed timestep, use as: while (clock.step()) update(clock.timestep());
+        bool step();
+
+        /// how far the simulation is between two steps, for interpolation
+        inline double alpha() const { return m_accumulator / m_timestep; }
+        inline double timestep() const { return m_timestep; }
+
+        /// wait for the end of the current frame
+        void wait();
+
+        /// time of the previous frame in seconds
+        inline double frame_time() const { return m_frame_time; }
+
+        inline const stats& statistics() const { return m_stats; }
+        void reset_statistics();
+
+        /// spin time at the end of wait(), trades CPU for precision
+        inline void spin(double seconds) { m_spin = seconds; }
+
+        /// run until update returns false, update(timestep) is called at
+        /// a fixed rate and render(alpha) once per frame
+        template<typename Update, typename Render>
+        void run(Update&& update, Render&& render) {
+            for (;;) {
+                tick();
+
+                while (step()) {
+                    if (!update(m_timestep))
+                        return;
+                }
+
+                render(alpha());
+                wait();
+            }
+        }
+
+    private:
+        const std::uint64_t m_period;
+        const double m_timestep;
+
+        // upper bound to the time fed to the simulation in one frame,
+        // avoids a spiral of death after a long stall
+        const double m_max_elapsed;
+
+        double m_spin = 0.002;
+
+        std::uint64_t m_deadline;
+        std::uint64_t m_last_tick;
+        std::uint64_t m_last_frame;
+
+        double m_accumulator = 0;
+        double m_frame_time = 0;
+
+        stats m_stats;
+        // running sum of squared differences (welford)
+        double m_m2 = 0;
+    };
+}
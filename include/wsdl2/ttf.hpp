@@ -14,6 +14,7 @@
 #ifdef WSDL2_TTF
 #include "wsdl2/util.hpp"
 #include "wsdl2/video.hpp"
+#include "wsdl2/profile.hpp"
 
 #include <string>
 #include <optional>
@@ -184,7 +185,7 @@ namespace wsdl2::ttf {
                                       &m.min_y, &m.max_y,
                                       &m.advance);
 
-            if (util::check_ttf(-1 == rv)) {
+            if (!util::check_ttf(-1 != rv)) {
                 return std::nullopt;
             }
 
@@ -195,7 +196,7 @@ namespace wsdl2::ttf {
 
         inline std::optional<std::pair<int, int>> text_size(const std::string& s) {
             int w, h;
-            if (util::check_ttf(-1 == TTF_SizeText(sdl(), s.c_str(), &w, &h))) {
+            if (!util::check_ttf(-1 != TTF_SizeText(sdl(), s.c_str(), &w, &h))) {
                 return std::nullopt;
             }
 
@@ -204,7 +205,7 @@ namespace wsdl2::ttf {
 
         inline std::optional<std::pair<int, int>> utf8_size(const std::string& s) {
             int w, h;
-            if (util::check_ttf(-1 == TTF_SizeUTF8(sdl(), s.c_str(), &w, &h))) {
+            if (!util::check_ttf(-1 != TTF_SizeUTF8(sdl(), s.c_str(), &w, &h))) {
                 return std::nullopt;
             }
 
@@ -213,7 +214,7 @@ namespace wsdl2::ttf {
         
         inline std::optional<std::pair<int, int>> unicode_size(const std::basic_string<std::uint16_t>& s) {
             int w, h;
-            if (util::check_ttf(-1 == TTF_SizeUNICODE(sdl(), s.c_str(), &w, &h))) {
+            if (!util::check_ttf(-1 != TTF_SizeUNICODE(sdl(), s.c_str(), &w, &h))) {
                 return std::nullopt;
             }
 
@@ -223,32 +224,36 @@ namespace wsdl2::ttf {
         /// solid (crappy) rendering
 
         std::optional<surface> render_text_solid(const std::string& s, color fg) {
+            wsdl2_profile_zone("ttf::font::render_text_solid");
             SDL_Surface *sdlsurf = TTF_RenderText_Solid(sdl(), s.c_str(), fg);
-            if (util::check_ttf(sdlsurf == NULL))
+            if (!util::check_ttf(sdlsurf != NULL))
                 return std::nullopt;
 
             return surface(sdlsurf);
         }
             
         std::optional<surface> render_utf8_solid(const std::string& s, color fg) {
+            wsdl2_profile_zone("ttf::font::render_utf8_solid");
             SDL_Surface *sdlsurf = TTF_RenderUTF8_Solid(sdl(), s.c_str(), fg);
-            if (util::check_ttf(sdlsurf == NULL))
+            if (!util::check_ttf(sdlsurf != NULL))
                 return std::nullopt;
 
             return surface(sdlsurf);
         }
         
         std::optional<surface> render_unicode_solid(const std::basic_string<std::uint16_t>& s, color fg) {
+            wsdl2_profile_zone("ttf::font::render_unicode_solid");
             SDL_Surface *sdlsurf = TTF_RenderUNICODE_Solid(sdl(), s.c_str(), fg);
-            if (util::check_ttf(sdlsurf == NULL))
+            if (!util::check_ttf(sdlsurf != NULL))
                 return std::nullopt;
 
             return surface(sdlsurf);
         }
 
         std::optional<surface> render_glyph_solid(std::uint16_t ch, color fg) {
+            wsdl2_profile_zone("ttf::font::render_glyph_solid");
             SDL_Surface *sdlsurf = TTF_RenderGlyph_Solid(sdl(), ch, fg);
-            if (util::check_ttf(sdlsurf == NULL))
+            if (!util::check_ttf(sdlsurf != NULL))
                 return std::nullopt;
 
             return surface(sdlsurf);
@@ -257,32 +262,36 @@ namespace wsdl2::ttf {
         /// shaded rendering
 
         std::optional<surface> render_text_shaded(const std::string& s, color fg, color bg) {
+            wsdl2_profile_zone("ttf::font::render_text_shaded");
             SDL_Surface *sdlsurf = TTF_RenderText_Shaded(sdl(), s.c_str(), fg, bg);
-            if (util::check_ttf(sdlsurf == NULL))
+            if (!util::check_ttf(sdlsurf != NULL))
                 return std::nullopt;
 
             return surface(sdlsurf);
         }
             
         std::optional<surface> render_utf8_shaded(const std::string& s, color fg, color bg) {
+            wsdl2_profile_zone("ttf::font::render_utf8_shaded");
             SDL_Surface *sdlsurf = TTF_RenderUTF8_Shaded(sdl(), s.c_str(), fg, bg);
-            if (util::check_ttf(sdlsurf == NULL))
+            if (!util::check_ttf(sdlsurf != NULL))
                 return std::nullopt;
 
             return surface(sdlsurf);
         }
         
         std::optional<surface> render_unicode_shaded(const std::basic_string<std::uint16_t>& s, color fg, color bg) {
+            wsdl2_profile_zone("ttf::font::render_unicode_shaded");
             SDL_Surface *sdlsurf = TTF_RenderUNICODE_Shaded(sdl(), s.c_str(), fg, bg);
-            if (util::check_ttf(sdlsurf == NULL))
+            if (!util::check_ttf(sdlsurf != NULL))
                 return std::nullopt;
 
             return surface(sdlsurf);
         }
 
         std::optional<surface> render_glyph_shaded(std::uint16_t ch, color fg, color bg) {
+            wsdl2_profile_zone("ttf::font::render_glyph_shaded");
             SDL_Surface *sdlsurf = TTF_RenderGlyph_Shaded(sdl(), ch, fg, bg);
-            if (util::check_ttf(sdlsurf == NULL))
+            if (!util::check_ttf(sdlsurf != NULL))
                 return std::nullopt;
 
             return surface(sdlsurf);
@@ -291,32 +300,36 @@ namespace wsdl2::ttf {
         /// blended (slow but good) rendering
 
         std::optional<surface> render_text_blended(const std::string& s, color fg) {
+            wsdl2_profile_zone("ttf::font::render_text_blended");
             SDL_Surface *sdlsurf = TTF_RenderText_Blended(sdl(), s.c_str(), fg);
-            if (util::check_ttf(sdlsurf == NULL))
+            if (!util::check_ttf(sdlsurf != NULL))
                 return std::nullopt;
 
             return surface(sdlsurf);
         }
             
         std::optional<surface> render_utf8_blended(const std::string& s, color fg) {
+            wsdl2_profile_zone("ttf::font::render_utf8_blended");
             SDL_Surface *sdlsurf = TTF_RenderUTF8_Blended(sdl(), s.c_str(), fg);
-            if (util::check_ttf(sdlsurf == NULL))
+            if (!util::check_ttf(sdlsurf != NULL))
                 return std::nullopt;
 
             return surface(sdlsurf);
         }
         
         std::optional<surface> render_unicode_blended(const std::basic_string<std::uint16_t>& s, color fg) {
+            wsdl2_profile_zone("ttf::font::render_unicode_blended");
             SDL_Surface *sdlsurf = TTF_RenderUNICODE_Blended(sdl(), s.c_str(), fg);
-            if (util::check_ttf(sdlsurf == NULL))
+            if (!util::check_ttf(sdlsurf != NULL))
                 return std::nullopt;
 
             return surface(sdlsurf);
         }
 
         std::optional<surface> render_glyph_blended(std::uint16_t ch, color fg) {
+            wsdl2_profile_zone("ttf::font::render_glyph_blended");
             SDL_Surface *sdlsurf = TTF_RenderGlyph_Blended(sdl(), ch, fg);
-            if (util::check_ttf(sdlsurf == NULL))
+            if (!util::check_ttf(sdlsurf != NULL))
                 return std::nullopt;
 
             return surface(sdlsurf);
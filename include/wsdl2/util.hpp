@@ -1,6 +1,9 @@
 #pragma once
 #include "debug.hpp"
 
+#include <atomic>
+#include <cstdint>
+
 extern "C" {
 #include <SDL2/SDL_error.h>
 
@@ -19,24 +22,25 @@ namespace wsdl2 {
         //     return (b) ? SDL_TRUE : SDL_FALSE;
         // }
 
+        /// number of failed checks, SDL and SDL_ttf
+        inline std::atomic<std::uint64_t> check_failures {0};
+
         constexpr inline bool check(bool expr) {
-#ifndef NDEBUG
             if (!expr) {
-                npdebug("an internal SDL error occurred:");
-                npdebug("  ", const_cast<const char * const>(SDL_GetError()));
+                check_failures++;
+                wsdl2_log(error, "an internal SDL error occurred: ", SDL_GetError());
             }
-#endif
+
             return expr;
         }
 
 #ifdef WSDL2_TTF
         constexpr inline bool check_ttf(bool expr) {
-#ifndef NDEBUG
             if (!expr) {
-                npdebug("an internal SDL_ttf error occurred:");
-                npdebug("  ", const_cast<const char * const>(TTF_GetError()));
+                check_failures++;
+                wsdl2_log(error, "an internal SDL_ttf error occurred: ", TTF_GetError());
             }
-#endif
+
             return expr;
         }
 #endif
@@ -1,15 +1,24 @@
 #pragma once
 
 #include "util.hpp"
+#include "event.hpp"
+#include "profile.hpp"
 
 #include <string>
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <type_traits>
-#include <unordered_map>
+#include <vector>
 
 extern "C" {
+#include <SDL2/SDL_version.h>
 #include <SDL2/SDL_video.h>
 #include <SDL2/SDL_render.h>
 }
@@ -23,6 +32,9 @@ namespace wsdl2 {
     class texture;
     class renderer;
     class window;
+    class canvas;
+    class recorder;
+    class virtual_texture;
 
     namespace event {
         class event;
@@ -147,12 +159,59 @@ namespace wsdl2 {
      */
     using color = SDL_Color;
 
-    // TODO: implement blend in texture
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    /* equivalent to
+     * struct vertex {
+     *     SDL_FPoint position;
+     *     color color;
+     *     SDL_FPoint tex_coord;  // normalized, 0 to 1
+     * };
+     */
+    using vertex = SDL_Vertex;
+#endif
+
     enum class blend_mode {
         none  = SDL_BLENDMODE_NONE,
         blend = SDL_BLENDMODE_BLEND,
         add   = SDL_BLENDMODE_ADD,
         mod   = SDL_BLENDMODE_MOD,
+#if SDL_VERSION_ATLEAST(2, 0, 12)
+        mul   = SDL_BLENDMODE_MUL,
+#endif
+        // colors already multiplied by alpha (see surface::premultiply()),
+        // a custom SDL blend mode, not every renderer supports it
+        premultiplied = 0x100,
+    };
+
+    /// SDL value of a blend mode
+    inline SDL_BlendMode sdl_blend_mode(blend_mode m) {
+        if (m != blend_mode::premultiplied)
+            return static_cast<SDL_BlendMode>(m);
+
+        static const SDL_BlendMode composed = SDL_ComposeCustomBlendMode(
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD
+        );
+
+        return composed;
+    }
+
+    inline blend_mode to_blend_mode(SDL_BlendMode m) {
+        if (m == sdl_blend_mode(blend_mode::premultiplied))
+            return blend_mode::premultiplied;
+
+        return static_cast<blend_mode>(m);
+    }
+
+    /// how the error is spread when colors lose precision
+    enum class dither {
+        none,
+        // 4x4 Bayer matrix, stable on animated and cut-out images
+        ordered,
+        // Floyd-Steinberg, smoother gradients on opaque images
+        diffusion,
+        // diffusion for opaque formats, ordered for those with alpha
+        automatic,
     };
 
     /// stores informations about the pixel format
@@ -207,14 +266,30 @@ namespace wsdl2 {
     }
 #endif
 
+    class surface;
+
+    namespace jobs {
+        /// call f(row, y) for every row of pixels of a surface in parallel
+        /// (in order without WSDL2_THREADS), declared here because surface
+        /// lets it lock its pixels
+        void parallel_rows(surface& s, const std::function<void(void *, int)>& f,
+                           int rows_per_job = 16);
+    }
+
     /// a graphical object allocated in the RAM
     class surface {
     public:
 
         friend class texture;
+        friend class renderer;
+        friend class canvas;
+        friend class virtual_texture;
+        friend struct static_texture;
 #ifdef WSDL2_TTF
         friend class ttf::font;
 #endif
+        friend void jobs::parallel_rows(surface&,
+            const std::function<void(void *, int)>&, int);
 
         surface() = delete;
         virtual ~surface();
@@ -246,20 +321,24 @@ namespace wsdl2 {
 
         /// copy a surface into another
         inline static void blit(surface& src, surface& dest) {
+            wsdl2_profile_zone("surface::blit");
             // copies the entire surface src, into dest at (0,0)
             util::check(0 == SDL_BlitSurface(src.sdl(), NULL, dest.sdl(), NULL));
         }
 
         inline static void blit(surface& src, rect& src_r, surface& dest, rect& dest_r) {
+            wsdl2_profile_zone("surface::blit");
             util::check(0 == SDL_BlitSurface(src.sdl(), &src_r, dest.sdl(), &dest_r));
         }
 
         inline static void blit_scaled(surface& src, surface& dest) {
+            wsdl2_profile_zone("surface::blit_scaled");
             // copies the entire surface src, into dest at (0,0)
             util::check(0 == SDL_BlitScaled(src.sdl(), NULL, dest.sdl(), NULL));
         }
 
         inline static void blit_scaled(surface& src, rect& src_r, surface& dest, rect& dest_r) {
+            wsdl2_profile_zone("surface::blit_scaled");
             util::check(0 == SDL_BlitScaled(src.sdl(), &src_r, dest.sdl(), &dest_r));
         }
 
@@ -343,6 +422,18 @@ namespace wsdl2 {
         }
 
         static std::optional<surface> load(const std::string& path);
+
+        /// multiply the colors by their alpha, for blend_mode::premultiplied;
+        /// surfaces with an alpha channel are converted to ARGB8888
+        bool premultiply();
+
+        /// write the surface to a bitmap file
+        inline bool save_bmp(const std::string& path) {
+            return util::check(0 == SDL_SaveBMP(sdl(), path.c_str()));
+        }
+
+        /// number of SDL surfaces created by wsdl2 so far
+        static inline std::uint64_t created() { return _created; }
         
         // how about we don't allow this
         // void * pixels()
@@ -352,8 +443,9 @@ namespace wsdl2 {
             util::check(0 == SDL_SetSurfaceRLE(sdl(), enable));
         }
 
-        // TODO: finish pixelformat
-        // SDL_Surface convert(pixelformat f);
+        /// change the pixel format, dithered only when reducing to RGB565,
+        /// ARGB4444 or ARGB1555
+        bool convert(pixelformat::format f, dither d = dither::none);
 
     private:
 
@@ -363,12 +455,83 @@ namespace wsdl2 {
 
         SDL_Surface *m_surface;
 
+        static std::atomic<std::uint64_t> _created;
+
         // dirty C code
         SDL_Surface* sdl();
         SDL_Surface* sdl() const;
     };
 
 
+    /// what a renderer did during one frame
+    struct render_stats {
+        // draw calls by kind
+        std::uint32_t clears = 0;
+        std::uint32_t points = 0;
+        std::uint32_t lines = 0;
+        std::uint32_t rects = 0;
+        std::uint32_t fills = 0;
+        std::uint32_t copies = 0;
+        std::uint32_t geometry = 0;
+        std::uint32_t draw_calls = 0;
+
+        // every copy binds a texture, a switch binds a different one
+        std::uint32_t texture_binds = 0;
+        std::uint32_t texture_switches = 0;
+        std::uint32_t target_switches = 0;
+
+        // written through streaming_texture::lock() and texture::update()
+        std::uint64_t pixels_uploaded = 0;
+
+        // draws rejected by renderer::culling() before reaching SDL
+        std::uint32_t culled = 0;
+
+        // process-wide, counted since the previous present()
+        std::uint64_t surfaces_created = 0;
+        std::uint64_t check_failures = 0;
+    };
+
+    /// how a window creates its renderer
+    struct renderer_config {
+        enum class backend {
+            any,
+            accelerated,
+            software,
+        };
+
+        // fallback chain of SDL driver names ("opengl", "direct3d11",
+        // "metal", "software", ...) tried in order before letting SDL
+        // pick one, unknown names are skipped
+        std::vector<std::string> drivers;
+
+        backend type = backend::accelerated;
+        bool vsync = true;
+        bool target_texture = false;
+
+        // last resort when nothing above could be created
+        bool fallback_software = true;
+    };
+
+    /// capabilities of a renderer, from SDL_RendererInfo
+    struct renderer_info {
+        std::string name;
+
+        bool software = false;
+        bool accelerated = false;
+        bool vsync = false;
+        bool target_texture = false;
+
+        int max_texture_width = 0;
+        int max_texture_height = 0;
+
+        // formats that textures can have without conversion
+        std::vector<pixelformat::format> formats;
+
+        inline bool supports(pixelformat::format f) const {
+            return std::find(formats.begin(), formats.end(), f) != formats.end();
+        }
+    };
+
     /// the guy who does the actual hard stuff
     class renderer {
     public:
@@ -377,6 +540,7 @@ namespace wsdl2 {
         friend class static_texture;
         friend class streaming_texture;
         friend class target_texture;
+        friend class render_thread;
 
         enum class flip {
             none       = SDL_FLIP_NONE,
@@ -385,51 +549,163 @@ namespace wsdl2 {
         };
 
         renderer(window& w);
-        renderer(texture& t);
+        /// software renderer drawing into a surface, which must outlive it
+        renderer(surface& target);
 
         renderer(renderer&& other);
         virtual ~renderer();
 
-        // TODO: check that is a target texture
+        /// false if target is not a target texture
         bool set_target(texture& target);
-        inline void clear() { util::check(0 == SDL_RenderClear(sdl())); }
-        inline void present() { SDL_RenderPresent(sdl()); }
+
+        /// render to the window again
+        inline void reset_target() { switch_target(NULL); }
+
+        /// the current target, to switch back to it after drawing into
+        /// textures; its texture must still exist when restored
+        class saved_target {
+        public:
+            saved_target() = default;
+
+        private:
+            friend class renderer;
+
+            explicit saved_target(SDL_Texture *t) : m_texture(t) {}
+            SDL_Texture *m_texture = NULL;
+        };
+
+        inline saved_target target() const { return saved_target(m_target); }
+        inline void restore_target(const saved_target& t) { switch_target(t.m_texture); }
+
+        inline void clear() {
+            wsdl2_profile_zone("renderer::clear");
+            sync_viewport();
+            count(m_stats.clears);
+            util::check(0 == SDL_RenderClear(sdl()));
+        }
+
+        inline void present() {
+            wsdl2_profile_zone("renderer::present");
+            SDL_RenderPresent(sdl());
+            end_frame_stats();
+            sync_viewport();
+        }
+
+        /// counters of the last presented frame
+        inline const render_stats& stats() const { return m_last_stats; }
+
+        renderer_info info() const;
+
+#ifdef WSDL2_THREADS
+        /// read back the current target and queue it for the recorder,
+        /// call it before present(); false if the frame was dropped
+        bool capture(recorder& rec);
+#endif
+
+        /// names of the drivers compiled into SDL
+        static std::vector<std::string> drivers();
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        inline bool vsync(bool enable) {
+            return util::check(0 == SDL_RenderSetVSync(sdl(), enable ? 1 : 0));
+        }
+#endif
 
         // viewport
         inline void reset_viewport() {
             util::check(0 == SDL_RenderSetViewport(sdl(), NULL));
+            SDL_RenderGetViewport(sdl(), &m_viewport);
+            update_bounds();
         }
 
         inline void viewport(const rect& v) {
-            util::check(0 == SDL_RenderSetViewport(sdl(), &v));
+            if (v == m_viewport)
+                return;
+
+            if (util::check(0 == SDL_RenderSetViewport(sdl(), &v))) {
+                m_viewport = v;
+                update_bounds();
+            }
+        }
+
+        inline rect viewport() const { return m_viewport; }
+
+        /// draw at a fixed resolution letterboxed and scaled into the
+        /// output, 0 by 0 disables it; both change the viewport
+        bool logical_size(int width, int height);
+        /// scale every drawing coordinate
+        bool scale(float x, float y);
+
+        // clipping, relative to the viewport
+        inline void clip(const rect& r) {
+            if (m_clip && *m_clip == r)
+                return;
+
+            if (util::check(0 == SDL_RenderSetClipRect(sdl(), &r))) {
+                m_clip = r;
+                update_bounds();
+            }
         }
 
-        inline rect viewport() {
-            rect r;
-            SDL_RenderGetViewport(sdl(), &r);
+        inline void reset_clip() {
+            if (!m_clip)
+                return;
 
-            return r;
+            if (util::check(0 == SDL_RenderSetClipRect(sdl(), NULL))) {
+                m_clip.reset();
+                update_bounds();
+            }
         }
 
+        /// nullopt when clipping is disabled
+        inline std::optional<rect> clip() const { return m_clip; }
+
+        /// skip draws that fall entirely outside of the viewport and the
+        /// clip rectangle without calling SDL, see render_stats::culled
+        inline void culling(bool enable) { m_culling = enable; }
+        inline bool culling() const { return m_culling; }
+
         // set color
 
         inline void set_color(std::uint8_t r, std::uint8_t g, std::uint8_t b, std::uint8_t a) {
-            util::check(0 == SDL_SetRenderDrawColor(sdl(), r, g, b, a));
+            if (m_color.r == r && m_color.g == g && m_color.b == b && m_color.a == a)
+                return;
+
+            if (util::check(0 == SDL_SetRenderDrawColor(sdl(), r, g, b, a)))
+                m_color = color {r, g, b, a};
         }
 
         inline void set_color(const color& c) {
             set_color(c.r, c.g, c.b, c.a);
         }
 
-        inline color get_color() {
-            color c;
-            util::check(0 == SDL_GetRenderDrawColor(sdl(), &c.r, &c.g, &c.b, &c.a));
-            return c;
+        inline color get_color() const { return m_color; }
+
+        /// how draw_* and fill_* blend with the target
+        inline bool blend(blend_mode m) {
+            if (m == m_blend)
+                return true;
+
+            if (0 != SDL_SetRenderDrawBlendMode(sdl(), sdl_blend_mode(m)))
+                return false;
+
+            m_blend = m;
+            return true;
         }
 
+        inline blend_mode blend() const { return m_blend; }
+
+        /// whether textures and drawing can use the blend mode, the
+        /// software renderer has no custom ones (blend_mode::premultiplied)
+        bool supports(blend_mode m);
+
         // draw a single element
 
         inline void draw_point(int x, int y) {
+            if (culled(rect {x, y, 1, 1}))
+                return;
+
+            count(m_stats.points);
             util::check(0 == SDL_RenderDrawPoint(sdl(), x, y));
         }
 
@@ -438,6 +714,11 @@ namespace wsdl2 {
         }
 
         inline void draw_line(int x1, int y1, int x2, int y2) {
+            if (culled(rect {std::min(x1, x2), std::min(y1, y2),
+                    std::abs(x2 - x1) + 1, std::abs(y2 - y1) + 1}))
+                return;
+
+            count(m_stats.lines);
             util::check(0 == SDL_RenderDrawLine(sdl(), x1, y1, x2, y2));
         };
 
@@ -450,10 +731,18 @@ namespace wsdl2 {
         }
 
         inline void draw_rect(const rect& r) {
+            if (culled(r))
+                return;
+
+            count(m_stats.rects);
             util::check(0 == SDL_RenderDrawRect(sdl(), &r));
         }
 
         inline void fill_rect(const rect& r) {
+            if (culled(r))
+                return;
+
+            count(m_stats.fills);
             util::check(0 == SDL_RenderFillRect(sdl(), &r));
         }
 
@@ -461,24 +750,40 @@ namespace wsdl2 {
 
         template<template<typename> typename Container>
         inline void draw_lines(const Container<point>& points) {
-            util::check(0 == SDL_RenderDrawLines(sdl(), points.data(), points.size()));
+            count(m_stats.lines);
+            util::check(0 == SDL_RenderDrawLines(sdl(), points.data(),
+                static_cast<int>(points.size())));
         }
 
         template<template<typename> typename Container>
         inline void draw_points(const Container<point>& points) {
-            util::check(0 == SDL_RenderDrawLines(sdl(), points.data(), points.size()));
+            count(m_stats.points);
+            util::check(0 == SDL_RenderDrawPoints(sdl(), points.data(),
+                static_cast<int>(points.size())));
         }
 
         template<template<typename> typename Container>
         inline void draw_rects(const Container<rect>& rects) {
-            util::check(0 == SDL_RenderDrawLines(sdl(), rects.data(), rects.size()));
+            count(m_stats.rects);
+            util::check(0 == SDL_RenderDrawRects(sdl(), rects.data(),
+                static_cast<int>(rects.size())));
         }
 
         template<template<typename> typename Container>
         inline void fill_rects(const Container<rect>& rects) {
-            util::check(0 == SDL_RenderFillRects(sdl(), rects.data(), rects.size()));
+            count(m_stats.fills);
+            util::check(0 == SDL_RenderFillRects(sdl(), rects.data(),
+                static_cast<int>(rects.size())));
         }
 
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        /// draw triangles in one call, textured when t is not null (then
+        /// counted as a copy); without indices every three vertices are one
+        void render_geometry(const vertex *vertices, int vertex_count,
+                             const int *indices = nullptr, int index_count = 0,
+                             texture *t = nullptr);
+#endif
+
         // overloaded drawing function
 
         inline void draw(point&& p) { draw_point(std::forward<point>(p)); }
@@ -502,6 +807,7 @@ namespace wsdl2 {
 
         // fill the entire texture
         inline void fill() {
+            count(m_stats.fills);
             util::check(0 == SDL_RenderFillRect(sdl(), NULL));
         }
 
@@ -511,8 +817,81 @@ namespace wsdl2 {
     private:
         SDL_Renderer *m_renderer = NULL;
 
+        // statistics
+        render_stats m_stats;
+        render_stats m_last_stats;
+        SDL_Texture *m_bound = NULL;
+        // process-wide counters at the end of the previous frame, the
+        // first frame counts from the creation of the renderer
+        std::uint64_t m_surfaces_base = surface::created();
+        std::uint64_t m_failures_base = util::check_failures;
+
+        // shadow of the SDL state, setters skip calls that change nothing
+        color m_color {0, 0, 0, 255};
+        blend_mode m_blend = blend_mode::none;
+        SDL_Texture *m_target = NULL;
+        rect m_viewport {0, 0, 0, 0};
+        std::optional<rect> m_clip;
+
+        // culling, m_bounds is the visible area in viewport coordinates
+        bool m_culling = false;
+        rect m_bounds {0, 0, 0, 0};
+
+        void update_bounds();
+
+        /// SDL changes the viewport by itself when the window is resized,
+        /// read it back once per frame in clear() and present()
+        inline void sync_viewport() {
+            rect v;
+            SDL_RenderGetViewport(sdl(), &v);
+
+            if (!(v == m_viewport)) {
+                m_viewport = v;
+                update_bounds();
+            }
+        }
+
+        /// cheap rejection test, counts the culled draws
+        inline bool culled(const rect& r) {
+            if (!m_culling)
+                return false;
+
+            if (r.x >= m_bounds.x + m_bounds.w || r.x + r.w <= m_bounds.x
+                || r.y >= m_bounds.y + m_bounds.h || r.y + r.h <= m_bounds.y)
+            {
+                m_stats.culled++;
+                return true;
+            }
+
+            return false;
+        }
+
+        /// dest rotated around dest.x + center.x, dest.y + center.y
+        bool culled(const rect& dest, const point& center, double angle);
+
+        inline void count(std::uint32_t& kind) {
+            kind++;
+            m_stats.draw_calls++;
+        }
+
+        inline void count_copy(SDL_Texture *t) {
+            count(m_stats.copies);
+            m_stats.texture_binds++;
+
+            if (t != m_bound) {
+                m_stats.texture_switches++;
+                m_bound = t;
+            }
+        }
+
+        void end_frame_stats();
+
+        void switch_target(SDL_Texture *target);
+        /// read the state back from SDL, after creation and target switches
+        void load_state();
+
         renderer();
-        renderer(SDL_Window *win);
+        renderer(SDL_Window *win, const renderer_config& config);
 
         // dirty C code
         SDL_Renderer* sdl();
@@ -526,6 +905,7 @@ namespace wsdl2 {
     class texture {
     public:
         friend class renderer;
+        friend class render_thread;
 
         enum class access : int {
             static_ = SDL_TEXTUREACCESS_STATIC,
@@ -553,12 +933,19 @@ namespace wsdl2 {
         virtual ~texture();
 
         inline void render() {
+            wsdl2_profile_zone("texture::render");
+            m_renderer.count_copy(m_texture);
             util::check(0 == SDL_RenderCopy(
                 m_renderer.sdl(), m_texture, NULL, NULL
             ));
         }
 
         inline void render(rect& src, rect& dest) {
+            wsdl2_profile_zone("texture::render");
+            if (m_renderer.culled(dest))
+                return;
+
+            m_renderer.count_copy(m_texture);
             util::check(0 == SDL_RenderCopy(
                 m_renderer.sdl(), m_texture, &src, &dest
             ));
@@ -566,6 +953,11 @@ namespace wsdl2 {
 
         // suppose that the destination is derived dynamically
         inline void render(rect& src, rect dest) {
+            wsdl2_profile_zone("texture::render");
+            if (m_renderer.culled(dest))
+                return;
+
+            m_renderer.count_copy(m_texture);
             util::check(0 == SDL_RenderCopy(
                 m_renderer.sdl(), m_texture, &src, &dest
             ));
@@ -574,6 +966,11 @@ namespace wsdl2 {
         inline void render(rect& src, rect& dest, 
             const double angle, const point& center, renderer::flip flip)
         {
+            wsdl2_profile_zone("texture::render");
+            if (m_renderer.culled(dest, center, angle))
+                return;
+
+            m_renderer.count_copy(m_texture);
             util::check(0 == SDL_RenderCopyEx(
                 m_renderer.sdl(), m_texture,
                 &src, &dest, angle, &center,
@@ -581,24 +978,86 @@ namespace wsdl2 {
             ));
         }
 
+        /// draw a frame scaled to dest, the borders (in texture pixels)
+        /// keep their size and the center and edges are stretched
+        void render_nine_slice(const rect& dest, int left, int top, int right, int bottom);
+
+        /// repeat the texture at its size to fill dest
+        void render_tiled(const rect& dest);
+
+        /// replace the pixels in area (the same in both) with those of a
+        /// surface with the pixel format of the texture, slow on target textures
+        bool update(surface& pixels, const rect& area);
+
+        inline bool update(surface& pixels) {
+            return update(pixels, rect {0, 0,
+                std::min(pixels.width(), m_width), std::min(pixels.height(), m_height)
+            });
+        }
+
         inline bool alpha(std::uint8_t val) {
+            if (val == m_alpha)
+                return true;
+
             int supported = SDL_SetTextureAlphaMod(m_texture, val);
             if (supported == -1)
                 return false;
-            else if (supported == 0)
-                return true;
+            else if (supported == 0) {
+                m_alpha = val;
+
+                // premultiplied colors fade with the alpha as well
+                return m_blend != blend_mode::premultiplied || apply_color_mod();
+            }
 
             util::check(supported >= -1);
             return false;
 
         }
 
-        inline std::uint8_t alpha() const {
-            std::uint8_t val;
-            util::check(0 == SDL_GetTextureAlphaMod(m_texture, &val));
+        inline std::uint8_t alpha() const { return m_alpha; }
 
-            return val;
+        /// multiply the color of the texture when rendering
+        inline bool color_mod(std::uint8_t r, std::uint8_t g, std::uint8_t b) {
+            if (m_color_mod.r == r && m_color_mod.g == g && m_color_mod.b == b)
+                return true;
+
+            const color previous = m_color_mod;
+            m_color_mod = color {r, g, b, 255};
+
+            if (!apply_color_mod()) {
+                m_color_mod = previous;
+                return false;
+            }
+
+            return true;
+        }
+
+        inline bool color_mod(const color& c) {
+            return color_mod(c.r, c.g, c.b);
         }
+
+        inline color color_mod() const { return m_color_mod; }
+
+        /// false when the renderer does not support the mode
+        inline bool blend(blend_mode m) {
+            if (m == m_blend)
+                return true;
+
+            if (0 != SDL_SetTextureBlendMode(m_texture, sdl_blend_mode(m)))
+                return false;
+
+            const bool was_premultiplied = (m_blend == blend_mode::premultiplied);
+            m_blend = m;
+
+            // the alpha is folded into the color modulation of
+            // premultiplied textures only
+            if (m_alpha != 255 && was_premultiplied != (m == blend_mode::premultiplied))
+                apply_color_mod();
+
+            return true;
+        }
+
+        inline blend_mode blend() const { return m_blend; }
         
         virtual access pixel_access() const = 0;
 
@@ -630,6 +1089,27 @@ namespace wsdl2 {
 
     private:
         SDL_Texture *m_texture;
+
+        // shadow of the modulation and blending, read back from SDL by
+        // load_state(): textures created from a surface take its mods
+        std::uint8_t m_alpha = 255;
+        color m_color_mod {255, 255, 255, 255};
+        blend_mode m_blend = blend_mode::none;
+
+        void load_state();
+
+        /// the color modulation given to SDL, with the alpha modulation
+        /// folded in when the colors are premultiplied
+        color modulation() const;
+        bool apply_color_mod();
+
+        // vertices of the last render_nine_slice and render_tiled calls,
+        // rebuilt only when the destination or the parameters change
+        struct geometry;
+        std::unique_ptr<geometry> m_nine_slice;
+        std::unique_ptr<geometry> m_tiled;
+
+        void render_geometry(geometry& g);
     };
 
     struct static_texture : public texture
@@ -639,14 +1119,39 @@ namespace wsdl2 {
         static_texture(renderer& r, surface& surf, pixelformat::format p = pixelformat::format::unknown)
             : texture(r, surf, p) {}
 
+        // upload at 16 bits per pixel when the renderer supports it: RGB565
+        // if the surface is opaque, ARGB1555 if its alpha is only 0 or 255
+        // and ARGB4444 otherwise; surf is left untouched
+        static_texture(renderer& r, surface& surf, dither d);
+
+        /// VRAM saved by a reduced upload, compared to 32 bits per pixel
+        inline std::size_t bytes_saved() const { return m_bytes_saved; }
+
+        /// saved by all the static textures created so far
+        static inline std::uint64_t total_bytes_saved() { return _bytes_saved; }
+
+        /// 16 bit format for the content of surf, as chosen above before
+        /// checking what the renderer supports
+        static pixelformat::format reduced_format(surface& surf);
+
         // TODO, constexpr identifier
         virtual access pixel_access() const override
         {
             return access::static_;
         }
 
-        // load a non-modifiable texture from a file
-        static std::shared_ptr<texture> load(const std::string& path, renderer&);
+        // load a non-modifiable texture from a file, premultiplied
+        // textures are drawn with blend_mode::premultiplied, or loaded
+        // as usual when the renderer does not support it
+        static std::shared_ptr<texture> load(const std::string& path, renderer&,
+                                             bool premultiplied = false);
+
+    private:
+        std::size_t m_bytes_saved = 0;
+
+        static std::atomic<std::uint64_t> _bytes_saved;
+
+        static pixelformat::format reduced_format(renderer& r, surface& surf);
     };
 
     struct streaming_texture : public texture
@@ -669,6 +1174,8 @@ namespace wsdl2 {
                 sdl(), NULL, &pixels, &pitch
             ));
 
+            m_locked_pixels = static_cast<std::uint64_t>(width()) * height();
+
             return surface(pixels, width(), height(), 24, pitch);
         }
 
@@ -681,16 +1188,26 @@ namespace wsdl2 {
                 sdl(), &region, &pixels, &pitch
             ));
 
+            m_locked_pixels = static_cast<std::uint64_t>(region.w) * region.h;
+
             // TODO: un-hardcode 24 bit depth
             return surface(pixels, region.w, region.h, 24, pitch);
         }
 
-        inline void unlock() { SDL_UnlockTexture(sdl()); }
+        inline void unlock() {
+            SDL_UnlockTexture(sdl());
+
+            m_renderer.m_stats.pixels_uploaded += m_locked_pixels;
+            m_locked_pixels = 0;
+        }
 
         virtual access pixel_access() const override
         {
             return access::streaming;
         }
+
+    private:
+        std::uint64_t m_locked_pixels = 0;
     };
 
     struct target_texture : public texture
@@ -707,13 +1224,18 @@ namespace wsdl2 {
 
         // set as current render target
         inline void set_target() {
-            util::check(SDL_SetRenderTarget(m_renderer.sdl(), sdl()) == 0);
+            m_renderer.switch_target(sdl());
         }
 
         inline bool is_target() {
-            return SDL_GetRenderTarget(m_renderer.sdl()) == sdl();
+            return m_renderer.m_target == sdl();
         }
 
+        /// divide the colors by their alpha, for content drawn over a
+        /// transparent clear when blend_mode::premultiplied is not supported;
+        /// reads the texture back, it must be the current target
+        bool unpremultiply();
+
         // TODO, target functionalities
     };
 
@@ -721,13 +1243,17 @@ namespace wsdl2 {
     class window {
     public:
         friend class renderer;
+        friend class render_thread;
         friend class event::event;
+        friend void event::route();
 
         window() = delete;
         window(const window& other) = delete;
         window(window&& other);
 
         window(const std::string& title, std::size_t width, std::size_t height);
+        window(const std::string& title, std::size_t width, std::size_t height,
+               const renderer_config& config);
         virtual ~window();
 
         // setters
@@ -747,7 +1273,15 @@ namespace wsdl2 {
         void clear() const { m_renderer->clear(); }
         void present() const { m_renderer->present(); }
 
+        // events addressed to this window, filled by event::route()
+        std::optional<event::any> poll();
+
+        /// throws std::out_of_range for unknown ids
         static window& get(unsigned id);
+        /// returns nullptr for unknown ids
+        static window* find(unsigned id);
+
+        inline unsigned id() const { return m_id; }
 
         wsdl2::point size() const;
 
@@ -758,10 +1292,55 @@ namespace wsdl2 {
 
         mutable std::unique_ptr<renderer> m_renderer;
 
+        std::deque<SDL_Event> m_events;
+
         // dirty C code
         SDL_Window* sdl();
 
         // code used by events
-        static std::unordered_map<unsigned, window*> _windows;
+        struct slot {
+            unsigned id = 0;
+            window *win = nullptr;
+        };
+
+        /* open addressing table indexed by id modulo its (power of two)
+         * size with linear probing, kept at most half full; the full id
+         * is stored to reject stale or foreign lookups
+         */
+        static std::vector<slot> _windows;
+        static std::size_t _window_count;
+
+        static std::size_t probe(unsigned id);
+
+        static void register_window(window *w);
+        static void unregister_window(window *w);
+    };
+
+    /// renders into a surface with the software renderer, it needs
+    /// neither a display nor an initialized video subsystem
+    class canvas {
+    public:
+        canvas() = delete;
+        canvas(const canvas& other) = delete;
+        canvas(canvas&& other) = default;
+
+        canvas(int width, int height,
+               pixelformat::format p = pixelformat::format::argb8888);
+
+        // rendering
+        renderer& get_renderer() const { return *m_renderer; }
+        void clear() const { m_renderer->clear(); }
+        void present() const { m_renderer->present(); }
+
+        /// what has been rendered so far
+        surface& get_surface() { return m_surface; }
+
+        inline int width() { return m_surface.width(); }
+        inline int height() { return m_surface.height(); }
+
+    private:
+        // declared first, the renderer must be destroyed before it
+        surface m_surface;
+        mutable std::unique_ptr<renderer> m_renderer;
     };
 }
@@ -0,0 +1,101 @@
+#pragma once
+
+/* wsdl2 virtual texture header
+ *
+ * An image too large for a single texture, split into square tiles that
+ * are loaded on demand from a source only when they are visible. The
+ * uploaded tiles are kept in a least recently used cache bounded by a
+ * memory budget, evicted tiles give their texture to the next one.
+ *
+ */
+
+#include "wsdl2/video.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace wsdl2 {
+
+    class virtual_texture {
+    public:
+        /// copy the pixels of region (in image coordinates) at the top left
+        /// corner of dest, an ARGB8888 surface of at least the region size;
+        /// false if they could not be read
+        using loader = std::function<bool(const rect& region, surface& dest)>;
+
+        /// memory_budget is in bytes of uploaded tiles, tile_size is reduced
+        /// to the maximum texture size of the renderer
+        virtual_texture(renderer& r, int width, int height, loader l,
+                        int tile_size = 512, std::size_t memory_budget = 64 << 20);
+
+        /// tiles of an image already in RAM, which must outlive the texture
+        virtual_texture(renderer& r, surface& image,
+                        int tile_size = 512, std::size_t memory_budget = 64 << 20);
+
+        virtual_texture(const virtual_texture& other) = delete;
+
+        /// read the tiles from a headerless file of width * height ARGB8888
+        /// pixels, row by row, seeking to the region instead of mapping it all
+        static loader raw_file(const std::string& path, int width, int height);
+
+        inline int width() const { return m_width; }
+        inline int height() const { return m_height; }
+        inline int tile_size() const { return m_tile_size; }
+
+        /// draw the view (in image coordinates) scaled into dest, loading the
+        /// tiles that are not cached yet
+        void render(const rect& view, const rect& dest);
+
+        /// drop every cached tile, e.g. after the source has changed
+        void invalidate();
+
+        /// tiles cached and their size in VRAM
+        inline std::size_t cached() const { return m_cache.size(); }
+        inline std::size_t memory() const { return m_cache.size() * tile_bytes(); }
+
+        /// counters of the last render()
+        inline std::size_t drawn() const { return m_drawn; }
+        inline std::size_t loaded() const { return m_loaded; }
+
+        /// visible tiles skipped because the budget was used by the same frame
+        inline std::size_t missing() const { return m_missing; }
+
+    private:
+        struct tile {
+            std::uint64_t key;
+            std::unique_ptr<streaming_texture> tex;
+            std::uint64_t frame = 0;
+        };
+
+        renderer& m_renderer;
+        loader m_load;
+
+        const int m_width;
+        const int m_height;
+        const int m_tile_size;
+        const std::size_t m_capacity;
+
+        // most recently used first, the map points into the list
+        std::list<tile> m_cache;
+        std::unordered_map<std::uint64_t, std::list<tile>::iterator> m_index;
+
+        // tiles are read here before the upload
+        surface m_staging;
+
+        std::uint64_t m_frame = 0;
+        std::size_t m_drawn = 0;
+        std::size_t m_loaded = 0;
+        std::size_t m_missing = 0;
+
+        inline std::size_t tile_bytes() const {
+            return static_cast<std::size_t>(m_tile_size) * m_tile_size * 4;
+        }
+
+        /// nullptr if the tile cannot be loaded this frame
+        streaming_texture *fetch(int tx, int ty);
+    };
+}
@@ -0,0 +1,35 @@
+#include "wsdl2/input.hpp"
+
+using namespace wsdl2;
+
+void input_state::update() {
+    int count = 0;
+    const Uint8 *keys = SDL_GetKeyboardState(&count);
+
+    bitset now {};
+    for (std::size_t i = 0; i < static_cast<std::size_t>(count) && i < words * 64; i++) {
+        now[i >> 6] |= static_cast<std::uint64_t>(keys[i] != 0) << (i & 63);
+    }
+
+    for (std::size_t w = 0; w < words; w++) {
+        m_pressed[w] = now[w] & ~m_down[w];
+        m_released[w] = ~now[w] & m_down[w];
+    }
+
+    m_down = now;
+
+    point pos;
+    std::uint32_t buttons = SDL_GetMouseState(&pos.x, &pos.y);
+
+    m_buttons_pressed = buttons & ~m_buttons;
+    m_buttons_released = ~buttons & m_buttons;
+    m_buttons = buttons;
+
+    if (m_first) {
+        m_mouse = pos;
+        m_first = false;
+    }
+
+    m_mouse_delta = { pos.x - m_mouse.x, pos.y - m_mouse.y };
+    m_mouse = pos;
+}
@@ -0,0 +1,382 @@
+#ifdef WSDL2_THREADS
+
+#include "wsdl2/jobs.hpp"
+#include "wsdl2/debug.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+extern "C" {
+#include <SDL2/SDL_cpuinfo.h>
+}
+
+using namespace wsdl2;
+
+struct jobs::job {
+    std::function<void()> fn;
+    affinity aff = affinity::any;
+
+    // dependencies left, plus one while the job is being submitted
+    std::atomic<std::size_t> pending {0};
+    std::atomic<bool> complete {false};
+
+    // escaped from fn, written before complete is set
+    std::exception_ptr error;
+
+    std::mutex mutex;
+    bool finished = false;
+    std::vector<handle> continuations;
+};
+
+namespace {
+    class queue {
+    public:
+        inline void push(jobs::handle j) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_jobs.push_back(std::move(j));
+        }
+
+        /// owner side, newest first (cache is still warm)
+        inline jobs::handle pop() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_jobs.empty())
+                return nullptr;
+
+            jobs::handle j = std::move(m_jobs.back());
+            m_jobs.pop_back();
+            return j;
+        }
+
+        /// thief side, oldest first
+        inline jobs::handle steal() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_jobs.empty())
+                return nullptr;
+
+            jobs::handle j = std::move(m_jobs.front());
+            m_jobs.pop_front();
+            return j;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::deque<jobs::handle> m_jobs;
+    };
+
+    struct pool {
+        // one queue per worker, jobs submitted by workers go there
+        std::vector<std::unique_ptr<queue>> local;
+        // jobs submitted by other threads
+        queue injected;
+        // jobs with affinity::main and affinity::render
+        queue pinned[2];
+
+        std::vector<std::thread> workers;
+        std::atomic<bool> running {false};
+        std::atomic<std::size_t> queued {0};
+
+        std::mutex sleep_mutex;
+        std::condition_variable sleep_cv;
+    };
+
+    pool _pool;
+
+    thread_local int t_worker = -1;
+    thread_local jobs::affinity t_affinity = jobs::affinity::any;
+
+    void execute(const jobs::handle& j);
+
+    void schedule(jobs::handle j) {
+        switch (j->aff) {
+        case jobs::affinity::main:
+            _pool.pinned[0].push(std::move(j));
+            return;
+
+        case jobs::affinity::render:
+            _pool.pinned[1].push(std::move(j));
+            return;
+
+        case jobs::affinity::any:
+            break;
+        }
+
+        // without workers run right away
+        if (!_pool.running) {
+            execute(j);
+            return;
+        }
+
+        // counted first, a worker may take the job as soon as it is pushed
+        _pool.queued++;
+
+        if (t_worker >= 0)
+            _pool.local[static_cast<std::size_t>(t_worker)]->push(std::move(j));
+        else
+            _pool.injected.push(std::move(j));
+
+        {
+            // avoid a lost wake up between the check and the wait
+            std::lock_guard<std::mutex> lock(_pool.sleep_mutex);
+        }
+        _pool.sleep_cv.notify_one();
+    }
+
+    void execute(const jobs::handle& j) {
+        // a throwing job still completes, wait() rethrows the exception
+        try {
+            j->fn();
+        } catch (...) {
+            j->error = std::current_exception();
+        }
+
+        j->fn = nullptr;
+
+        std::vector<jobs::handle> continuations;
+        {
+            std::lock_guard<std::mutex> lock(j->mutex);
+            j->finished = true;
+            continuations.swap(j->continuations);
+        }
+
+        j->complete = true;
+
+        for (auto& c : continuations) {
+            if (--c->pending == 0)
+                schedule(std::move(c));
+        }
+    }
+
+    /// own queue first, then the injected jobs, then steal
+    jobs::handle find(int worker) {
+        jobs::handle j;
+        const std::size_t n = _pool.local.size();
+
+        if (worker >= 0 && (j = _pool.local[static_cast<std::size_t>(worker)]->pop()))
+            return j;
+
+        if ((j = _pool.injected.steal()))
+            return j;
+
+        for (std::size_t i = 1; i <= n; i++) {
+            std::size_t victim = (static_cast<std::size_t>(worker + 1) + i) % n;
+            if ((j = _pool.local[victim]->steal()))
+                return j;
+        }
+
+        return nullptr;
+    }
+
+    void work(int worker) {
+        t_worker = worker;
+
+        for (;;) {
+            if (jobs::handle j = find(worker)) {
+                _pool.queued--;
+                execute(j);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(_pool.sleep_mutex);
+            if (!_pool.running && _pool.queued == 0)
+                break;
+
+            _pool.sleep_cv.wait(lock, [] {
+                return _pool.queued > 0 || !_pool.running;
+            });
+        }
+    }
+
+    /// run something else while waiting, false if there was nothing
+    bool help() {
+        if (jobs::handle j = find(t_worker)) {
+            _pool.queued--;
+            execute(j);
+            return true;
+        }
+
+        if (t_affinity != jobs::affinity::any)
+            return jobs::run_pending(t_affinity) > 0;
+
+        return false;
+    }
+
+    void finish(const jobs::handle& h) {
+        while (!jobs::done(h)) {
+            if (!help())
+                std::this_thread::yield();
+        }
+    }
+}
+
+void jobs::start(unsigned workers /* = 0 */) {
+    if (_pool.running)
+        return;
+
+    if (workers == 0)
+        workers = static_cast<unsigned>(std::max(1, SDL_GetCPUCount() - 1));
+
+    t_affinity = affinity::main;
+    _pool.running = true;
+
+    for (unsigned i = 0; i < workers; i++)
+        _pool.local.push_back(std::make_unique<queue>());
+
+    for (unsigned i = 0; i < workers; i++)
+        _pool.workers.emplace_back(work, static_cast<int>(i));
+
+    npdebug("started ", workers, " job workers");
+}
+
+void jobs::stop() {
+    if (!_pool.running)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(_pool.sleep_mutex);
+        _pool.running = false;
+    }
+
+    _pool.sleep_cv.notify_all();
+
+    for (auto& w : _pool.workers)
+        w.join();
+
+    _pool.workers.clear();
+    _pool.local.clear();
+    npdebug("stopped job workers");
+}
+
+unsigned jobs::worker_count() {
+    return static_cast<unsigned>(_pool.workers.size());
+}
+
+jobs::handle jobs::submit(std::function<void()> f,
+    const std::vector<handle>& deps, affinity a /* = affinity::any */)
+{
+    auto j = std::make_shared<job>();
+    j->fn = std::move(f);
+    j->aff = a;
+    j->pending = deps.size() + 1;
+
+    for (const handle& d : deps) {
+        if (!d) {
+            j->pending--;
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(d->mutex);
+        if (d->finished)
+            j->pending--;
+        else
+            d->continuations.push_back(j);
+    }
+
+    if (--j->pending == 0)
+        schedule(j);
+
+    return j;
+}
+
+jobs::handle jobs::submit(std::function<void()> f,
+    std::initializer_list<handle> deps /* = {} */, affinity a /* = affinity::any */)
+{
+    return submit(std::move(f), std::vector<handle>(deps), a);
+}
+
+bool jobs::done(const handle& h) {
+    return !h || h->complete;
+}
+
+void jobs::wait(const handle& h) {
+    finish(h);
+
+    if (h && h->error)
+        std::rethrow_exception(h->error);
+}
+
+void jobs::wait(const std::vector<handle>& hs) {
+    for (const handle& h : hs)
+        finish(h);
+
+    for (const handle& h : hs) {
+        if (h && h->error)
+            std::rethrow_exception(h->error);
+    }
+}
+
+std::size_t jobs::run_pending(affinity a) {
+    if (a == affinity::any)
+        return 0;
+
+    t_affinity = a;
+    queue& q = _pool.pinned[(a == affinity::main) ? 0 : 1];
+
+    std::size_t count = 0;
+    while (handle j = q.steal()) {
+        execute(j);
+        count++;
+    }
+
+    return count;
+}
+
+void jobs::parallel_for(std::size_t begin, std::size_t end, std::size_t grain,
+    const std::function<void(std::size_t, std::size_t)>& f)
+{
+    if (end <= begin)
+        return;
+
+    grain = std::max<std::size_t>(grain, 1);
+
+    std::vector<handle> chunks;
+    std::size_t first = begin;
+
+    for (; first + grain < end; first += grain) {
+        std::size_t last = first + grain;
+        chunks.push_back(submit([&f, first, last] { f(first, last); }));
+    }
+
+    // the calling thread takes the last chunk, the others refer to f
+    // and must be over before leaving even when it throws
+    try {
+        f(first, end);
+    } catch (...) {
+        for (const handle& h : chunks)
+            finish(h);
+
+        throw;
+    }
+
+    wait(chunks);
+}
+
+void jobs::parallel_rows(surface& s, const std::function<void(void *, int)>& f,
+    int rows_per_job /* = 16 */)
+{
+    s.lock();
+
+    auto *pixels = static_cast<std::uint8_t*>(s.sdl()->pixels);
+    const auto pitch = static_cast<std::size_t>(s.sdl()->pitch);
+
+    try {
+        parallel_for(0, static_cast<std::size_t>(s.height()),
+            static_cast<std::size_t>(std::max(rows_per_job, 1)),
+            [&](std::size_t first, std::size_t last) {
+                for (std::size_t y = first; y < last; y++)
+                    f(pixels + y * pitch, static_cast<int>(y));
+            }
+        );
+    } catch (...) {
+        s.unlock();
+        throw;
+    }
+
+    s.unlock();
+}
+
+#endif
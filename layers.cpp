@@ -0,0 +1,101 @@
+#include "wsdl2/layers.hpp"
+#include "wsdl2/debug.hpp"
+
+#include <algorithm>
+
+using namespace wsdl2;
+
+/* class layer */
+
+layer::layer(renderer& r, int width, int height, painter p)
+    : m_renderer(r),
+      // needs an alpha channel to be composited over other layers
+      m_texture(r, width, height, pixelformat::format::argb8888),
+      m_paint(std::move(p))
+{
+    // drawing with blend_mode::blend over a transparent target leaves
+    // premultiplied colors, blending them again would darken the edges
+    if (!m_texture.blend(blend_mode::premultiplied))
+        m_texture.blend(blend_mode::blend);
+}
+
+void layer::update() {
+    if (!m_dirty)
+        return;
+
+    wsdl2_profile_zone("layer::update");
+
+    const color previous = m_renderer.get_color();
+
+    m_texture.set_target();
+    m_renderer.set_color(0, 0, 0, 0);
+    m_renderer.clear();
+    m_renderer.set_color(previous);
+
+    if (m_paint)
+        m_paint(m_renderer);
+
+    // composited with blend_mode::blend, which multiplies by alpha again
+    if (m_texture.blend() != blend_mode::premultiplied)
+        m_texture.unpremultiply();
+
+    m_dirty = false;
+}
+
+void layer::render() {
+    if (!m_visible || m_alpha == 0)
+        return;
+
+    rect src {0, 0, width(), height()};
+
+    m_texture.alpha(m_alpha);
+    m_texture.render(src, rect {m_position.x, m_position.y, width(), height()});
+}
+
+/* class compositor */
+
+layer& compositor::add(int width, int height, layer::painter p, int z /* = 0 */) {
+    m_layers.push_back(std::make_unique<layer>(m_renderer, width, height, std::move(p)));
+    m_layers.back()->z(z);
+
+    return *m_layers.back();
+}
+
+void compositor::remove(const layer& l) {
+    m_layers.erase(std::remove_if(m_layers.begin(), m_layers.end(),
+        [&l](const auto& owned) { return owned.get() == &l; }),
+        m_layers.end()
+    );
+}
+
+void compositor::invalidate_all() {
+    for (auto& l : m_layers)
+        l->invalidate();
+}
+
+void compositor::render() {
+    wsdl2_profile_zone("compositor::render");
+
+    auto by_z = [](const auto& a, const auto& b) { return a->z() < b->z(); };
+
+    // z rarely changes, the check is cheaper than sorting
+    if (!std::is_sorted(m_layers.begin(), m_layers.end(), by_z))
+        std::stable_sort(m_layers.begin(), m_layers.end(), by_z);
+
+    // the layers become the target while redrawn
+    const renderer::saved_target previous = m_renderer.target();
+    bool redrawn = false;
+
+    for (auto& l : m_layers) {
+        if (l->dirty() && l->visible()) {
+            l->update();
+            redrawn = true;
+        }
+    }
+
+    if (redrawn)
+        m_renderer.restore_target(previous);
+
+    for (auto& l : m_layers)
+        l->render();
+}
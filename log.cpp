@@ -0,0 +1,266 @@
+#include "wsdl2/log.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+#ifdef WSDL2_THREADS
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif
+
+using namespace wsdl2;
+
+namespace {
+    const char * level_name(log::level l) {
+        switch (l) {
+        case log::level::trace: return "trace";
+        case log::level::debug: return "debug";
+        case log::level::info:  return "info";
+        case log::level::warn:  return "warn";
+        case log::level::error: return "error";
+        case log::level::off:   break;
+        }
+
+        return "";
+    }
+
+    struct message {
+        log::level lvl;
+        const char *file;
+        int line;
+        const char *func;
+        std::size_t length;
+        // longer messages are truncated
+        char text[216];
+    };
+
+    void print(const message& m) {
+        std::fprintf(stderr, "[%s %s:%d, %s] %.*s\n",
+            level_name(m.lvl), m.file, m.line, m.func,
+            static_cast<int>(m.length), m.text
+        );
+    }
+
+    std::atomic<std::uint64_t> _dropped {0};
+}
+
+#ifdef WSDL2_THREADS
+
+namespace {
+    /// single producer (the owning thread), single consumer (the writer)
+    struct ring {
+        static constexpr std::size_t capacity = 1024;
+
+        std::array<message, capacity> messages;
+        std::atomic<std::size_t> head {0};
+        std::atomic<std::size_t> tail {0};
+    };
+
+    class writer {
+    public:
+        writer() { start(); }
+
+        // only if wsdl2::quit() was not called
+        ~writer() { stop(); }
+
+        void start() {
+            std::lock_guard<std::mutex> lock(m_wake_mutex);
+            if (m_thread.joinable())
+                return;
+
+            m_running = true;
+            m_thread = std::thread(&writer::loop, this);
+        }
+
+        /// join the thread, what is queued afterwards is written by
+        /// the threads that log
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lock(m_wake_mutex);
+                if (!m_thread.joinable())
+                    return;
+
+                m_running = false;
+            }
+
+            m_wake.notify_one();
+            m_thread.join();
+            m_thread = std::thread();
+        }
+
+        inline bool running() const { return m_running; }
+
+        void add(std::shared_ptr<ring> r) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_rings.push_back(std::move(r));
+        }
+
+        /// after a message has been queued, locks only if the thread sleeps
+        inline void notify() {
+            if (!m_asleep)
+                return;
+
+            {
+                std::lock_guard<std::mutex> lock(m_wake_mutex);
+                m_woken = true;
+            }
+
+            m_wake.notify_one();
+        }
+
+        /// write out everything that is queued, returns how much
+        std::size_t drain() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::size_t count = 0;
+
+            for (auto& r : m_rings) {
+                std::size_t tail = r->tail.load(std::memory_order_relaxed);
+                std::size_t head = r->head.load(std::memory_order_acquire);
+
+                for (; tail != head; tail++, count++)
+                    print(r->messages[tail % ring::capacity]);
+
+                r->tail.store(tail, std::memory_order_release);
+            }
+
+            // rings of threads that have exited are not needed anymore
+            m_rings.erase(std::remove_if(m_rings.begin(), m_rings.end(),
+                [](const auto& r) {
+                    return r.use_count() == 1
+                        && r->tail.load() == r->head.load();
+                }), m_rings.end()
+            );
+
+            if (count > 0)
+                std::fflush(stderr);
+
+            return count;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::vector<std::shared_ptr<ring>> m_rings;
+
+        std::mutex m_wake_mutex;
+        std::condition_variable m_wake;
+        bool m_woken = false;
+        std::atomic<bool> m_asleep {false};
+        std::atomic<bool> m_running {false};
+
+        std::thread m_thread;
+
+        bool queued() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            return std::any_of(m_rings.begin(), m_rings.end(), [](const auto& r) {
+                return r->tail.load() != r->head.load();
+            });
+        }
+
+        void loop() {
+            while (m_running) {
+                if (drain() > 0)
+                    continue;
+
+                std::unique_lock<std::mutex> lock(m_wake_mutex);
+
+                // a message queued before m_asleep was set did not notify,
+                // one queued after it does; both are sequentially consistent
+                m_asleep = true;
+                if (!queued()) {
+                    m_wake.wait(lock, [this] { return m_woken || !m_running; });
+                }
+
+                m_asleep = false;
+                m_woken = false;
+            }
+
+            drain();
+        }
+    };
+
+    writer& get_writer() {
+        static writer w;
+        return w;
+    }
+
+    ring& local_ring() {
+        thread_local std::shared_ptr<ring> r = [] {
+            auto created = std::make_shared<ring>();
+            get_writer().add(created);
+            return created;
+        }();
+
+        return *r;
+    }
+}
+
+void log::submit(level l, const char *file, int line, const char *func,
+    const std::string& msg)
+{
+    ring& r = local_ring();
+
+    std::size_t head = r.head.load(std::memory_order_relaxed);
+    if (head - r.tail.load(std::memory_order_acquire) >= ring::capacity) {
+        _dropped++;
+        return;
+    }
+
+    message& m = r.messages[head % ring::capacity];
+    m.lvl = l;
+    m.file = file;
+    m.line = line;
+    m.func = func;
+    m.length = std::min(msg.size(), sizeof(m.text));
+    std::memcpy(m.text, msg.data(), m.length);
+
+    // sequentially consistent, so that notify() sees the writer asleep
+    // or the writer sees the message
+    r.head.store(head + 1);
+
+    writer& w = get_writer();
+    if (w.running())
+        w.notify();
+    else
+        w.drain();
+}
+
+void log::flush() {
+    get_writer().drain();
+}
+
+void log::stop() {
+    get_writer().stop();
+}
+
+#else
+
+// without threads messages are written right away, still without
+// flushing stderr on every line
+void log::submit(level l, const char *file, int line, const char *func,
+    const std::string& msg)
+{
+    message m { l, file, line, func, std::min(msg.size(), sizeof(message::text)), {} };
+    std::memcpy(m.text, msg.data(), m.length);
+    print(m);
+}
+
+void log::flush() {
+    std::fflush(stderr);
+}
+
+void log::stop() {
+    std::fflush(stderr);
+}
+
+#endif
+
+std::uint64_t log::dropped() {
+    return _dropped;
+}
@@ -0,0 +1,223 @@
+#include "wsdl2/particles.hpp"
+#include "wsdl2/debug.hpp"
+
+#ifdef WSDL2_THREADS
+#include "wsdl2/jobs.hpp"
+#endif
+
+#include <algorithm>
+#include <cmath>
+
+using namespace wsdl2;
+
+static inline std::uint8_t mix(std::uint8_t a, std::uint8_t b, float t) {
+    const float fa = static_cast<float>(a);
+    return static_cast<std::uint8_t>(fa + (static_cast<float>(b) - fa) * t + 0.5f);
+}
+
+static inline color mix(const color& a, const color& b, float t) {
+    return color {mix(a.r, b.r, t), mix(a.g, b.g, t), mix(a.b, b.b, t), mix(a.a, b.a, t)};
+}
+
+emitter::emitter(renderer& r, texture& t, std::size_t capacity)
+    : emitter(r, t, capacity, settings())
+{}
+
+emitter::emitter(renderer& r, texture& t, std::size_t capacity, const settings& s)
+    : m_renderer(r),
+      m_texture(t),
+      m_settings(s),
+      m_capacity(capacity),
+      m_px(capacity), m_py(capacity),
+      m_vx(capacity), m_vy(capacity),
+      m_age(capacity), m_life(capacity),
+      m_random(std::random_device {}())
+{
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    m_vertices.reserve(capacity * 4);
+#endif
+}
+
+std::size_t emitter::burst(std::size_t n) {
+    n = std::min(n, m_capacity - m_count);
+    spawn(n);
+
+    return n;
+}
+
+void emitter::clear() {
+    m_count = 0;
+    m_pending = 0.0f;
+}
+
+void emitter::spawn(std::size_t n) {
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    const settings& s = m_settings;
+
+    for (std::size_t i = m_count; i < m_count + n; i++) {
+        const float angle = s.angle + s.angle_spread * unit(m_random);
+        const float speed = s.speed + s.speed_spread * unit(m_random);
+
+        m_px[i] = m_x;
+        m_py[i] = m_y;
+        m_vx[i] = std::cos(angle) * speed;
+        m_vy[i] = std::sin(angle) * speed;
+        m_age[i] = 0.0f;
+        m_life[i] = std::max(s.lifetime + s.lifetime_spread * unit(m_random), 0.001f);
+    }
+
+    m_count += n;
+}
+
+void emitter::integrate(std::size_t first, std::size_t last, float dt) {
+    // one component per loop and no branches, so that they are vectorized
+    float *px = m_px.data();
+    float *py = m_py.data();
+    float *vx = m_vx.data();
+    float *vy = m_vy.data();
+    float *age = m_age.data();
+
+    const float gx = m_settings.gravity_x * dt;
+    const float gy = m_settings.gravity_y * dt;
+
+    for (std::size_t i = first; i < last; i++)
+        vx[i] += gx;
+
+    for (std::size_t i = first; i < last; i++)
+        vy[i] += gy;
+
+    for (std::size_t i = first; i < last; i++)
+        px[i] += vx[i] * dt;
+
+    for (std::size_t i = first; i < last; i++)
+        py[i] += vy[i] * dt;
+
+    for (std::size_t i = first; i < last; i++)
+        age[i] += dt;
+}
+
+void emitter::expire() {
+    // the last alive particle takes the place of a dead one, the order
+    // does not matter and the arrays stay packed
+    std::size_t i = 0;
+    while (i < m_count) {
+        if (m_age[i] < m_life[i]) {
+            i++;
+            continue;
+        }
+
+        m_count--;
+        m_px[i] = m_px[m_count];
+        m_py[i] = m_py[m_count];
+        m_vx[i] = m_vx[m_count];
+        m_vy[i] = m_vy[m_count];
+        m_age[i] = m_age[m_count];
+        m_life[i] = m_life[m_count];
+    }
+}
+
+void emitter::update(float dt, bool parallel /* = false */) {
+    wsdl2_profile_zone("emitter::update");
+
+    bool split = false;
+
+#ifdef WSDL2_THREADS
+    // below this a job costs more than it saves
+    constexpr std::size_t grain = 16384;
+
+    if (parallel && m_count >= 2 * grain && jobs::worker_count() > 0) {
+        jobs::parallel_for(0, m_count, grain, [this, dt](std::size_t first, std::size_t last) {
+            integrate(first, last, dt);
+        });
+
+        split = true;
+    }
+#else
+    (void) parallel;
+#endif
+
+    if (!split)
+        integrate(0, m_count, dt);
+
+    expire();
+
+    if (m_active && m_settings.rate > 0.0f) {
+        m_pending += m_settings.rate * dt;
+
+        const auto n = static_cast<std::size_t>(m_pending);
+        m_pending -= static_cast<float>(n);
+        burst(n);
+    }
+}
+
+void emitter::render() {
+    wsdl2_profile_zone("emitter::render");
+
+    if (m_count == 0)
+        return;
+
+    const settings& s = m_settings;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    // the same two triangles for every quad
+    if (m_indices.size() < m_count * 6) {
+        std::size_t q = m_indices.size() / 6;
+        m_indices.resize(m_count * 6);
+
+        for (; q < m_count; q++) {
+            const int base = static_cast<int>(q * 4);
+            int *idx = &m_indices[q * 6];
+
+            idx[0] = base;
+            idx[1] = base + 1;
+            idx[2] = base + 2;
+            idx[3] = base;
+            idx[4] = base + 2;
+            idx[5] = base + 3;
+        }
+    }
+
+    m_vertices.resize(m_count * 4);
+
+    for (std::size_t i = 0; i < m_count; i++) {
+        const float t = std::min(m_age[i] / m_life[i], 1.0f);
+        const float half = (s.size_start + (s.size_end - s.size_start) * t) * 0.5f;
+        const color c = mix(s.color_start, s.color_end, t);
+
+        const float x0 = m_px[i] - half, x1 = m_px[i] + half;
+        const float y0 = m_py[i] - half, y1 = m_py[i] + half;
+
+        vertex *v = &m_vertices[i * 4];
+        v[0] = vertex {{x0, y0}, c, {0.0f, 0.0f}};
+        v[1] = vertex {{x1, y0}, c, {1.0f, 0.0f}};
+        v[2] = vertex {{x1, y1}, c, {1.0f, 1.0f}};
+        v[3] = vertex {{x0, y1}, c, {0.0f, 1.0f}};
+    }
+
+    m_renderer.render_geometry(m_vertices.data(), static_cast<int>(m_count * 4),
+        m_indices.data(), static_cast<int>(m_count * 6), &m_texture
+    );
+#else
+    // one copy per particle, modulated like the vertices would be
+    const color mod = m_texture.color_mod();
+    const std::uint8_t alpha = m_texture.alpha();
+
+    rect src {0, 0, m_texture.width(), m_texture.height()};
+
+    for (std::size_t i = 0; i < m_count; i++) {
+        const float t = std::min(m_age[i] / m_life[i], 1.0f);
+        const float size = s.size_start + (s.size_end - s.size_start) * t;
+        const color c = mix(s.color_start, s.color_end, t);
+
+        m_texture.color_mod(c);
+        m_texture.alpha(c.a);
+        m_texture.render(src, rect {
+            static_cast<int>(m_px[i] - size * 0.5f), static_cast<int>(m_py[i] - size * 0.5f),
+            static_cast<int>(size), static_cast<int>(size)
+        });
+    }
+
+    m_texture.color_mod(mod);
+    m_texture.alpha(alpha);
+#endif
+}
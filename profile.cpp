@@ -0,0 +1,171 @@
+#ifdef WSDL2_PROFILE
+
+#include "wsdl2/profile.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace wsdl2;
+
+namespace {
+    /// written only by the thread of its ring, read by the others: seq is
+    /// 0 while the entry is written, then its index in the ring + 1
+    struct entry {
+        std::atomic<std::size_t> seq {0};
+        std::atomic<const char *> name {nullptr};
+        std::atomic<std::uint64_t> begin {0};
+        std::atomic<std::uint64_t> end {0};
+    };
+
+    /// written only by its thread, old zones are overwritten
+    struct ring {
+        static constexpr std::size_t capacity = 1 << 16;
+
+        std::array<entry, capacity> entries;
+        std::atomic<std::size_t> head {0};
+        // moved up to head by clear(), the owner only writes head
+        std::atomic<std::size_t> tail {0};
+        std::atomic<bool> exited {false};
+        unsigned tid;
+
+        inline std::size_t first(std::size_t h) const {
+            return std::max(tail.load(std::memory_order_acquire),
+                (h > capacity) ? h - capacity : 0);
+        }
+    };
+
+    std::mutex _rings_mutex;
+    // rings are kept after their thread exits until they are dumped or
+    // cleared, empty ones are released when the thread exits
+    std::vector<std::shared_ptr<ring>> _rings;
+    unsigned _next_tid = 0;
+
+    const std::uint64_t _epoch = timing::now();
+
+    void release_exited(bool all) {
+        _rings.erase(std::remove_if(_rings.begin(), _rings.end(),
+            [all](const auto& r) {
+                if (!r->exited.load(std::memory_order_acquire))
+                    return false;
+
+                return all || r->first(r->head.load(std::memory_order_acquire))
+                    >= r->head.load(std::memory_order_acquire);
+            }),
+            _rings.end()
+        );
+    }
+
+    /// registers the ring of a thread and marks it when the thread exits
+    struct owner {
+        std::shared_ptr<ring> r = std::make_shared<ring>();
+
+        owner() {
+            std::lock_guard<std::mutex> lock(_rings_mutex);
+            r->tid = _next_tid++;
+            _rings.push_back(r);
+        }
+
+        ~owner() {
+            r->exited.store(true, std::memory_order_release);
+
+            std::lock_guard<std::mutex> lock(_rings_mutex);
+            release_exited(false);
+        }
+    };
+
+    ring& local_ring() {
+        thread_local owner o;
+        return *o.r;
+    }
+
+    void write_escaped(std::ostream& out, const char *s) {
+        for (; *s != '\0'; s++) {
+            if (*s == '"' || *s == '\\')
+                out << '\\';
+
+            out << *s;
+        }
+    }
+}
+
+void profile::record(const char *name, std::uint64_t begin, std::uint64_t end) {
+    ring& r = local_ring();
+    const std::size_t h = r.head.load(std::memory_order_relaxed);
+    entry& e = r.entries[h % ring::capacity];
+
+    // readers drop the entry if they see it while it changes
+    e.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    e.name.store(name, std::memory_order_relaxed);
+    e.begin.store(begin, std::memory_order_relaxed);
+    e.end.store(end, std::memory_order_relaxed);
+
+    e.seq.store(h + 1, std::memory_order_release);
+    r.head.store(h + 1, std::memory_order_release);
+}
+
+void profile::write_chrome_trace(std::ostream& out) {
+    const double us = 1e6 / static_cast<double>(timing::frequency());
+    bool first = true;
+
+    out << "{\"traceEvents\":[";
+
+    std::lock_guard<std::mutex> lock(_rings_mutex);
+    for (const auto& r : _rings) {
+        const std::size_t head = r->head.load(std::memory_order_acquire);
+
+        for (std::size_t i = r->first(head); i < head; i++) {
+            const entry& e = r->entries[i % ring::capacity];
+
+            if (e.seq.load(std::memory_order_acquire) != i + 1)
+                continue;
+
+            const char *name = e.name.load(std::memory_order_relaxed);
+            const std::uint64_t begin = e.begin.load(std::memory_order_relaxed);
+            const std::uint64_t end = e.end.load(std::memory_order_relaxed);
+
+            // overwritten by the owner while being read
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (e.seq.load(std::memory_order_relaxed) != i + 1)
+                continue;
+
+            if (!first)
+                out << ",";
+            first = false;
+
+            out << "\n{\"name\":\"";
+            write_escaped(out, name);
+            out << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << r->tid
+                << ",\"ts\":" << static_cast<double>(begin - _epoch) * us
+                << ",\"dur\":" << static_cast<double>(end - begin) * us
+                << "}";
+        }
+    }
+
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+bool profile::write_chrome_trace(const std::string& path) {
+    std::ofstream out(path);
+    if (!out)
+        return false;
+
+    write_chrome_trace(out);
+    return static_cast<bool>(out);
+}
+
+void profile::clear() {
+    std::lock_guard<std::mutex> lock(_rings_mutex);
+    release_exited(true);
+
+    for (const auto& r : _rings)
+        r->tail.store(r->head.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+#endif
@@ -0,0 +1,297 @@
+#ifdef WSDL2_THREADS
+
+#include "wsdl2/render_thread.hpp"
+#include "wsdl2/jobs.hpp"
+#include "wsdl2/debug.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+extern "C" {
+#include <SDL2/SDL_render.h>
+}
+
+using namespace wsdl2;
+
+render_thread::render_thread(window& w, const renderer_config& config /* = renderer_config() */)
+    : m_window(w), m_config(config)
+{
+    // destroyed by the thread that created it, a window has one renderer
+    w.m_renderer.reset();
+
+    m_thread = std::thread(&render_thread::loop, this);
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this] { return m_started; });
+    }
+
+    if (!m_renderer) {
+        m_thread.join();
+        rethrow();
+    }
+
+    npdebug("started render thread");
+}
+
+render_thread::~render_thread() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+
+    m_cv.notify_all();
+    m_thread.join();
+    npdebug("stopped render thread");
+
+    // give the window back a renderer owned by this thread
+    try {
+        m_window.m_renderer.reset(new renderer(m_window.sdl(), m_config));
+    } catch (const std::exception& e) {
+        wsdl2_log(error, "could not recreate the renderer of the window: ", e.what());
+    }
+}
+
+void render_thread::submit(command_buffer&& cmds, int layer /* = 0 */) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_recording.buffers.emplace_back(layer, std::move(cmds));
+}
+
+void render_thread::end_frame() {
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this] { return !m_pending; });
+
+        m_pending = std::move(m_recording);
+        m_recording = frame();
+    }
+
+    m_cv.notify_all();
+    rethrow();
+}
+
+void render_thread::flush() {
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this] { return !m_pending && !m_busy; });
+    }
+
+    rethrow();
+}
+
+texture_proxy render_thread::create_texture(surface&& surf) {
+    auto s = std::make_shared<texture_proxy::state>();
+    s->width = surf.width();
+    s->height = surf.height();
+    s->source.emplace(std::move(surf));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_recording.uploads.push_back(s);
+
+    return texture_proxy(s);
+}
+
+texture_proxy render_thread::create_target(int width, int height) {
+    auto s = std::make_shared<texture_proxy::state>();
+    s->width = width;
+    s->height = height;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_recording.uploads.push_back(s);
+
+    return texture_proxy(s);
+}
+
+void render_thread::rethrow() {
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::swap(error, m_error);
+    }
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void render_thread::loop() {
+    try {
+        m_renderer.reset(new renderer(m_window.sdl(), m_config));
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_error = std::current_exception();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_started = true;
+    }
+
+    m_cv.notify_all();
+
+    if (!m_renderer)
+        return;
+
+    for (;;) {
+        frame f;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_pending || !m_running; });
+
+            // render what was handed over before stopping
+            if (!m_pending)
+                break;
+
+            f = std::move(*m_pending);
+            m_pending.reset();
+            m_busy = true;
+        }
+
+        // the next frame can be handed over
+        m_cv.notify_all();
+
+        try {
+            jobs::run_pending(jobs::affinity::render);
+            execute(f);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_error = std::current_exception();
+        }
+
+        // release the proxies held by the commands on this thread
+        f = frame();
+        collect();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_busy = false;
+        }
+
+        m_cv.notify_all();
+    }
+
+    // SDL textures and the renderer must be destroyed by this thread
+    for (auto& s : m_textures) {
+        s->ready.store(false, std::memory_order_release);
+        s->tex.reset();
+    }
+
+    m_textures.clear();
+    m_renderer.reset();
+}
+
+void render_thread::execute(frame& f) {
+    // create the textures first, they may be used in this frame
+    for (auto& s : f.uploads) {
+        if (s->source) {
+            s->tex = std::make_unique<static_texture>(*m_renderer, *s->source);
+            s->source.reset();
+        } else {
+            s->tex = std::make_unique<target_texture>(*m_renderer, s->width, s->height);
+        }
+
+        s->ready.store(true, std::memory_order_release);
+        m_textures.push_back(std::move(s));
+    }
+
+    // merge the buffers
+    std::stable_sort(f.buffers.begin(), f.buffers.end(),
+        [](const auto& a, const auto& b) { return a.first < b.first; }
+    );
+
+    for (auto& [layer, buffer] : f.buffers) {
+        for (auto& c : buffer.m_commands) {
+            std::visit([this](auto& cmd) {
+                using T = std::decay_t<decltype(cmd)>;
+                using cmds = command_buffer::cmd;
+
+                if constexpr (std::is_same_v<T, cmds::color>) {
+                    m_renderer->set_color(cmd.c);
+                }
+
+                if constexpr (std::is_same_v<T, cmds::clear>) {
+                    m_renderer->clear();
+                }
+
+                if constexpr (std::is_same_v<T, cmds::viewport>) {
+                    if (cmd.v)
+                        m_renderer->viewport(*cmd.v);
+                    else
+                        m_renderer->reset_viewport();
+                }
+
+                if constexpr (std::is_same_v<T, cmds::target>) {
+                    if (cmd.t.ready())
+                        m_renderer->set_target(*cmd.t.m_state->tex);
+                    else
+                        m_renderer->reset_target();
+                }
+
+                if constexpr (std::is_same_v<T, cmds::point>) {
+                    m_renderer->draw_point(cmd.p);
+                }
+
+                if constexpr (std::is_same_v<T, cmds::line>) {
+                    m_renderer->draw_line(cmd.a, cmd.b);
+                }
+
+                if constexpr (std::is_same_v<T, cmds::rect>) {
+                    if (cmd.fill)
+                        m_renderer->fill_rect(cmd.r);
+                    else
+                        m_renderer->draw_rect(cmd.r);
+                }
+
+                if constexpr (std::is_same_v<T, cmds::copy>) {
+                    if (!cmd.t.ready())
+                        return;
+
+                    if (cmd.dest && m_renderer->culled(*cmd.dest))
+                        return;
+
+                    m_renderer->count_copy(cmd.t.m_state->tex->sdl());
+                    util::check(0 == SDL_RenderCopy(
+                        m_renderer->sdl(), cmd.t.m_state->tex->sdl(),
+                        cmd.src ? &*cmd.src : NULL,
+                        cmd.dest ? &*cmd.dest : NULL
+                    ));
+                }
+
+                if constexpr (std::is_same_v<T, cmds::copy_ex>) {
+                    if (!cmd.t.ready())
+                        return;
+
+                    if (m_renderer->culled(cmd.dest, cmd.center, cmd.angle))
+                        return;
+
+                    m_renderer->count_copy(cmd.t.m_state->tex->sdl());
+                    util::check(0 == SDL_RenderCopyEx(
+                        m_renderer->sdl(), cmd.t.m_state->tex->sdl(),
+                        &cmd.src, &cmd.dest, cmd.angle, &cmd.center,
+                        static_cast<SDL_RendererFlip>(cmd.flip)
+                    ));
+                }
+
+                if constexpr (std::is_same_v<T, cmds::call>) {
+                    cmd.f(*m_renderer);
+                }
+            }, c);
+        }
+    }
+
+    m_renderer->present();
+}
+
+void render_thread::collect() {
+    // textures that are referenced only by this thread are not used anymore
+    auto unused = std::remove_if(m_textures.begin(), m_textures.end(),
+        [](const auto& s) { return s.use_count() == 1; }
+    );
+
+    for (auto it = unused; it != m_textures.end(); ++it)
+        (*it)->tex.reset();
+
+    m_textures.erase(unused, m_textures.end());
+}
+
+#endif
@@ -0,0 +1,435 @@
+#include "wsdl2/shapes.hpp"
+#include "wsdl2/debug.hpp"
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace wsdl2;
+
+namespace {
+    constexpr float pi = 3.14159265f;
+
+    enum kind : int {
+        filled_circle = 1,
+        outlined_circle,
+        filled_polygon,
+        polyline,
+        closed_polyline,
+    };
+
+    // the chord error stays under a quarter of a pixel
+    int circle_segments(float radius) {
+        if (radius <= 1.0f)
+            return 8;
+
+        const float step = 2.0f * std::acos(1.0f - 0.25f / radius);
+        return std::clamp(static_cast<int>(std::ceil(2.0f * pi / step)), 8, 512);
+    }
+
+    inline fpoint add(const fpoint& a, const fpoint& b) { return fpoint {a.x + b.x, a.y + b.y}; }
+    inline fpoint sub(const fpoint& a, const fpoint& b) { return fpoint {a.x - b.x, a.y - b.y}; }
+    inline fpoint scale(const fpoint& a, float s) { return fpoint {a.x * s, a.y * s}; }
+    inline float cross(const fpoint& a, const fpoint& b) { return a.x * b.y - a.y * b.x; }
+    inline float dot(const fpoint& a, const fpoint& b) { return a.x * b.x + a.y * b.y; }
+
+    // false for a zero-length vector
+    inline bool normalize(fpoint& v) {
+        const float len = std::sqrt(dot(v, v));
+        if (len <= 1e-6f)
+            return false;
+
+        v = scale(v, 1.0f / len);
+        return true;
+    }
+
+    // counter-clockwise turn from a to c through b, in screen coordinates
+    inline float turn(const fpoint& a, const fpoint& b, const fpoint& c) {
+        return cross(sub(b, a), sub(c, a));
+    }
+
+    bool inside_triangle(const fpoint& p, const fpoint& a, const fpoint& b, const fpoint& c) {
+        return turn(a, b, p) >= 0.0f && turn(b, c, p) >= 0.0f && turn(c, a, p) >= 0.0f;
+    }
+}
+
+shapes::shapes(renderer& r, std::size_t capacity /* = 256 */)
+    : m_renderer(r), m_capacity(std::max<std::size_t>(capacity, 1))
+{}
+
+void shapes::clear() {
+    m_index.clear();
+    m_cache.clear();
+}
+
+void shapes::begin_key(int k, const color& c, std::initializer_list<float> params) {
+    m_key.clear();
+    m_key.push_back(static_cast<float>(k));
+    m_key.push_back(static_cast<float>(c.r));
+    m_key.push_back(static_cast<float>(c.g));
+    m_key.push_back(static_cast<float>(c.b));
+    m_key.push_back(static_cast<float>(c.a));
+    m_key.insert(m_key.end(), params);
+}
+
+const std::vector<fpoint>& shapes::add_key(const std::vector<fpoint>& points, fpoint& origin) {
+    // relative to the first point, so that moving a shape keeps its key
+    origin = points.empty() ? fpoint {0.0f, 0.0f} : points.front();
+
+    m_local.clear();
+    for (const fpoint& p : points) {
+        m_local.push_back(sub(p, origin));
+        m_key.push_back(m_local.back().x);
+        m_key.push_back(m_local.back().y);
+    }
+
+    return m_local;
+}
+
+shapes::mesh& shapes::fetch(bool& fresh) {
+    // FNV-1a over the bits of the parameters
+    std::uint64_t hash = 14695981039346656037ull;
+    for (float f : m_key) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+
+        hash = (hash ^ bits) * 1099511628211ull;
+    }
+
+    auto found = m_index.find(hash);
+    if (found != m_index.end()) {
+        m_cache.splice(m_cache.begin(), m_cache, found->second);
+
+        entry& e = *found->second;
+        if (e.key == m_key) {
+            m_hits++;
+            fresh = false;
+            return e.m;
+        }
+
+        // a collision, the older shape is replaced
+        e.key = m_key;
+        e.m.vertices.clear();
+        e.m.indices.clear();
+
+        m_misses++;
+        fresh = true;
+        return e.m;
+    }
+
+    if (m_cache.size() >= m_capacity) {
+        m_index.erase(m_cache.back().hash);
+        m_cache.pop_back();
+    }
+
+    m_cache.push_front(entry {hash, m_key, mesh()});
+    m_index[hash] = m_cache.begin();
+
+    m_misses++;
+    fresh = true;
+    return m_cache.front().m;
+}
+
+void shapes::submit(const mesh& m, const fpoint& origin) {
+    if (m.indices.empty())
+        return;
+
+    // meshes are cached in local coordinates
+    m_placed.resize(m.vertices.size());
+    for (std::size_t i = 0; i < m.vertices.size(); i++) {
+        m_placed[i] = m.vertices[i];
+        m_placed[i].position = add(m.vertices[i].position, origin);
+    }
+
+    m_renderer.render_geometry(
+        m_placed.data(), static_cast<int>(m_placed.size()),
+        m.indices.data(), static_cast<int>(m.indices.size())
+    );
+}
+
+void shapes::fill_circle(const fpoint& center, float radius, const color& c) {
+    wsdl2_profile_zone("shapes::fill_circle");
+
+    begin_key(filled_circle, c, {radius});
+
+    bool fresh;
+    mesh& m = fetch(fresh);
+
+    if (fresh && radius > 0.0f) {
+        const int n = circle_segments(radius);
+
+        // a fan around the center
+        m.vertices.push_back(vertex {{0.0f, 0.0f}, c, {0.0f, 0.0f}});
+
+        for (int i = 0; i < n; i++) {
+            const float a = 2.0f * pi * static_cast<float>(i) / static_cast<float>(n);
+            m.vertices.push_back(vertex {
+                {radius * std::cos(a), radius * std::sin(a)}, c, {0.0f, 0.0f}
+            });
+
+            m.indices.push_back(0);
+            m.indices.push_back(1 + i);
+            m.indices.push_back(1 + (i + 1) % n);
+        }
+    }
+
+    submit(m, center);
+}
+
+void shapes::draw_circle(const fpoint& center, float radius, float thickness, const color& c) {
+    wsdl2_profile_zone("shapes::draw_circle");
+
+    begin_key(outlined_circle, c, {radius, thickness});
+
+    bool fresh;
+    mesh& m = fetch(fresh);
+
+    if (fresh && radius > 0.0f && thickness > 0.0f) {
+        const float inner = std::max(radius - thickness * 0.5f, 0.0f);
+        const float outer = radius + thickness * 0.5f;
+        const int n = circle_segments(outer);
+
+        // a ring, inner and outer vertices alternate
+        for (int i = 0; i < n; i++) {
+            const float a = 2.0f * pi * static_cast<float>(i) / static_cast<float>(n);
+            const float ca = std::cos(a), sa = std::sin(a);
+
+            m.vertices.push_back(vertex {{inner * ca, inner * sa}, c, {0.0f, 0.0f}});
+            m.vertices.push_back(vertex {{outer * ca, outer * sa}, c, {0.0f, 0.0f}});
+
+            const int j = (i + 1) % n;
+            for (int idx : {2 * i, 2 * i + 1, 2 * j + 1, 2 * i, 2 * j + 1, 2 * j})
+                m.indices.push_back(idx);
+        }
+    }
+
+    submit(m, center);
+}
+
+void shapes::fill_polygon(const std::vector<fpoint>& shape, const color& c) {
+    wsdl2_profile_zone("shapes::fill_polygon");
+
+    fpoint origin;
+    begin_key(filled_polygon, c, {});
+    const std::vector<fpoint>& points = add_key(shape, origin);
+
+    bool fresh;
+    mesh& m = fetch(fresh);
+
+    if (fresh && points.size() >= 3) {
+        for (const fpoint& p : points)
+            m.vertices.push_back(vertex {p, c, {0.0f, 0.0f}});
+
+        // ear clipping on a counter-clockwise copy of the indices
+        std::vector<int> left(points.size());
+        for (std::size_t i = 0; i < left.size(); i++)
+            left[i] = static_cast<int>(i);
+
+        float area = 0.0f;
+        for (std::size_t i = 0; i < points.size(); i++)
+            area += cross(points[i], points[(i + 1) % points.size()]);
+
+        if (area < 0.0f)
+            std::reverse(left.begin(), left.end());
+
+        auto at = [&points](int i) -> const fpoint& {
+            return points[static_cast<std::size_t>(i)];
+        };
+
+        while (left.size() > 3) {
+            const std::size_t k = left.size();
+            bool clipped = false;
+
+            for (std::size_t i = 0; i < k && !clipped; i++) {
+                const int a = left[(i + k - 1) % k];
+                const int b = left[i];
+                const int d = left[(i + 1) % k];
+
+                const float corner = turn(at(a), at(b), at(d));
+
+                // a flat corner changes nothing, it is dropped
+                if (std::fabs(corner) <= 1e-6f) {
+                    left.erase(left.begin() + static_cast<std::ptrdiff_t>(i));
+                    clipped = true;
+                    continue;
+                }
+
+                // reflex corners are not ears
+                if (corner < 0.0f)
+                    continue;
+
+                bool ear = true;
+                for (int other : left) {
+                    if (other != a && other != b && other != d
+                        && inside_triangle(at(other), at(a), at(b), at(d)))
+                    {
+                        ear = false;
+                        break;
+                    }
+                }
+
+                if (!ear)
+                    continue;
+
+                for (int idx : {a, b, d})
+                    m.indices.push_back(idx);
+
+                left.erase(left.begin() + static_cast<std::ptrdiff_t>(i));
+                clipped = true;
+            }
+
+            // self-intersecting, what is left cannot be filled
+            if (!clipped) {
+                npdebug("fill_polygon: polygon is not simple, ", left.size(), " vertices skipped");
+                break;
+            }
+        }
+
+        if (left.size() == 3) {
+            for (int idx : left)
+                m.indices.push_back(idx);
+        }
+    }
+
+    submit(m, origin);
+}
+
+void shapes::draw_polygon(const std::vector<fpoint>& points, float thickness, const color& c,
+    join j /* = join::miter */)
+{
+    wsdl2_profile_zone("shapes::draw_polygon");
+    stroke(points, thickness, c, j, true);
+}
+
+void shapes::draw_polyline(const std::vector<fpoint>& points, float thickness, const color& c,
+    join j /* = join::miter */)
+{
+    wsdl2_profile_zone("shapes::draw_polyline");
+    stroke(points, thickness, c, j, false);
+}
+
+void shapes::stroke(const std::vector<fpoint>& shape, float thickness, const color& c,
+    join j, bool closed)
+{
+    fpoint origin;
+    begin_key(closed ? closed_polyline : polyline, c, {thickness, static_cast<float>(j)});
+    const std::vector<fpoint>& points = add_key(shape, origin);
+
+    bool fresh;
+    mesh& m = fetch(fresh);
+
+    const std::size_t n = points.size();
+    if (!fresh || n < 2 || thickness <= 0.0f) {
+        submit(m, origin);
+        return;
+    }
+
+    const float half = thickness * 0.5f;
+
+    auto vert = [&m, &c](const fpoint& p) {
+        m.vertices.push_back(vertex {p, c, {0.0f, 0.0f}});
+        return static_cast<int>(m.vertices.size() - 1);
+    };
+
+    auto triangle = [&m](int a, int b, int d) {
+        for (int idx : {a, b, d})
+            m.indices.push_back(idx);
+    };
+
+    // one quad per segment
+    const std::size_t segments = closed ? n : n - 1;
+    for (std::size_t s = 0; s < segments; s++) {
+        const fpoint& a = points[s];
+        const fpoint& b = points[(s + 1) % n];
+
+        fpoint d = sub(b, a);
+        if (!normalize(d))
+            continue;
+
+        const fpoint side = scale(fpoint {-d.y, d.x}, half);
+
+        const int v0 = vert(add(a, side));
+        const int v1 = vert(add(b, side));
+        const int v2 = vert(sub(b, side));
+        const int v3 = vert(sub(a, side));
+
+        triangle(v0, v1, v2);
+        triangle(v0, v2, v3);
+    }
+
+    // fill the gap on the outer side of every corner
+    const std::size_t first = closed ? 0 : 1;
+    const std::size_t last = closed ? n : n - 1;
+
+    for (std::size_t i = first; i < last; i++) {
+        const fpoint& p = points[i];
+
+        fpoint d0 = sub(p, points[(i + n - 1) % n]);
+        fpoint d1 = sub(points[(i + 1) % n], p);
+        if (!normalize(d0) || !normalize(d1))
+            continue;
+
+        const float bend = cross(d0, d1);
+        if (std::fabs(bend) < 1e-6f)
+            continue;
+
+        // the sides point left of the direction, the outer side is
+        // opposite to the turn
+        const float outward = (bend > 0.0f) ? -half : half;
+        const fpoint n0 = scale(fpoint {-d0.y, d0.x}, outward);
+        const fpoint n1 = scale(fpoint {-d1.y, d1.x}, outward);
+
+        const int center = vert(p);
+        const int from = vert(add(p, n0));
+        const int to = vert(add(p, n1));
+
+        if (j == join::bevel) {
+            triangle(center, from, to);
+            continue;
+        }
+
+        if (j == join::miter) {
+            fpoint mid = add(n0, n1);
+            const float cosine = normalize(mid) ? dot(mid, n0) / half : 0.0f;
+
+            // too sharp, the tip would go far from the corner
+            if (cosine < 0.25f) {
+                triangle(center, from, to);
+                continue;
+            }
+
+            const int tip = vert(add(p, scale(mid, half / cosine)));
+            triangle(center, from, tip);
+            triangle(center, tip, to);
+            continue;
+        }
+
+        // round, a fan along the arc between both sides
+        const float a0 = std::atan2(n0.y, n0.x);
+        float delta = std::atan2(n1.y, n1.x) - a0;
+        if (delta > pi)
+            delta -= 2.0f * pi;
+        else if (delta < -pi)
+            delta += 2.0f * pi;
+
+        const int steps = std::max(1, static_cast<int>(std::ceil(
+            std::fabs(delta) / (2.0f * pi) * static_cast<float>(circle_segments(half))
+        )));
+
+        int previous = from;
+        for (int k = 1; k <= steps; k++) {
+            const float a = a0 + delta * static_cast<float>(k) / static_cast<float>(steps);
+            const int next = (k == steps) ? to
+                : vert(fpoint {p.x + half * std::cos(a), p.y + half * std::sin(a)});
+
+            triangle(center, previous, next);
+            previous = next;
+        }
+    }
+
+    submit(m, origin);
+}
+
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+
+/* helpers shared by the tests
+ *
+ * Tests are plain programs: they count the failed checks, report each
+ * on stderr and return 1 if any failed.
+ *
+ */
+
+#include "wsdl2/video.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace test {
+
+    class checks {
+    public:
+        /// the context values are printed after what failed
+        template<typename... Context>
+        void expect(bool condition, const char *what, const Context&... context) {
+            if (condition)
+                return;
+
+            std::cerr << "failed: " << what;
+            if constexpr (sizeof...(context) > 0) {
+                const char *separator = " for ";
+                ((std::cerr << separator << context, separator = ", "), ...);
+            }
+            std::cerr << "\n";
+
+            m_failures++;
+        }
+
+        /// the exit code of the test
+        int result() const {
+            if (m_failures == 0)
+                return 0;
+
+            std::cerr << m_failures << " checks failed\n";
+            return 1;
+        }
+
+    private:
+        int m_failures = 0;
+    };
+
+    constexpr int rmask = 0x00ff0000;
+    constexpr int gmask = 0x0000ff00;
+    constexpr int bmask = 0x000000ff;
+
+    /// what has been rendered on the canvas as ARGB8888, with the alpha
+    /// byte set
+    inline std::vector<std::uint32_t> read(wsdl2::canvas& c) {
+        std::vector<std::uint32_t> pixels(static_cast<std::size_t>(c.width() * c.height()), 0);
+
+        wsdl2::surface copy(pixels.data(),
+            static_cast<std::size_t>(c.width()), static_cast<std::size_t>(c.height()),
+            32, c.width() * 4, rmask, gmask, bmask);
+
+        wsdl2::surface::blit(c.get_surface(), copy);
+
+        for (std::uint32_t& p : pixels)
+            p |= 0xff000000u;
+
+        return pixels;
+    }
+}
@@ -0,0 +1,122 @@
+#include "checks.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// reduction of flat colors to 16 bits per pixel: with dithering the
+// average of the expanded output stays within one unit of the input
+namespace {
+    constexpr int amask = static_cast<int>(0xff000000u);
+    constexpr int rmask = 0x00ff0000;
+    constexpr int gmask = 0x0000ff00;
+    constexpr int bmask = 0x000000ff;
+
+    constexpr int size = 16;
+
+    // a size x size surface of one color, converted to RGB565
+    std::vector<std::uint16_t> reduce(int r, int g, int b, wsdl2::dither d) {
+        std::vector<std::uint32_t> in(size * size, 0xff000000u
+            | static_cast<std::uint32_t>(r) << 16 | static_cast<std::uint32_t>(g) << 8
+            | static_cast<std::uint32_t>(b));
+
+        wsdl2::surface s(in.data(), size, size, 32, size * 4, rmask, gmask, bmask, amask);
+        s.convert(wsdl2::pixelformat::format::rgb565, d);
+
+        // opaque, so the blit is a copy
+        std::vector<std::uint16_t> out(size * size, 0);
+        wsdl2::surface copy(out.data(), size, size, 16, size * 2, 0xf800, 0x07e0, 0x001f);
+        wsdl2::surface::blit(s, copy);
+
+        return out;
+    }
+
+    int expand(int q, int levels) {
+        return (q * 255 + levels / 2) / levels;
+    }
+
+    // average of a channel, expanded back to 8 bits
+    double mean(const std::vector<std::uint16_t>& px, int shift, int bits) {
+        const int levels = (1 << bits) - 1;
+        double sum = 0.0;
+
+        for (std::uint16_t p : px)
+            sum += expand((p >> shift) & levels, levels);
+
+        return sum / static_cast<double>(px.size());
+    }
+
+    wsdl2::surface argb(std::vector<std::uint32_t>& pixels) {
+        return wsdl2::surface(pixels.data(), 4, 4, 32, 4 * 4, rmask, gmask, bmask, amask);
+    }
+}
+
+int main() {
+
+    using namespace wsdl2;
+
+    test::checks t;
+
+    for (dither d : {dither::ordered, dither::diffusion}) {
+        const char *name = (d == dither::ordered) ? "ordered" : "diffusion";
+
+        // the extremes are exact
+        for (std::uint16_t p : reduce(0, 0, 0, d))
+            t.expect(p == 0x0000, name, 0);
+
+        for (std::uint16_t p : reduce(255, 255, 255, d))
+            t.expect(p == 0xffff, name, 255);
+
+        for (int v = 0; v < 256; v += 3) {
+            const auto px = reduce(v, v, v, d);
+
+            t.expect(std::fabs(mean(px, 11, 5) - v) <= 1.0, name, v);
+            t.expect(std::fabs(mean(px, 5, 6) - v) <= 1.0, name, v);
+            t.expect(std::fabs(mean(px, 0, 5) - v) <= 1.0, name, v);
+        }
+    }
+
+    // without dithering every pixel gets the same value
+    for (int v = 0; v < 256; v += 3) {
+        const auto px = reduce(v, v, v, dither::none);
+        for (std::uint16_t p : px)
+            t.expect(p == px[0], "none", v);
+    }
+
+    // format selection by alpha content
+    {
+        std::vector<std::uint32_t> opaque(16, 0xff204080u);
+        surface s = argb(opaque);
+        t.expect(static_texture::reduced_format(s) == pixelformat::format::rgb565,
+            "opaque is RGB565", 0);
+    }
+
+    {
+        std::vector<std::uint32_t> cut_out(16, 0xff204080u);
+        cut_out[3] = 0x00000000u;
+        cut_out[7] = 0x00ffffffu;
+
+        surface s = argb(cut_out);
+        t.expect(static_texture::reduced_format(s) == pixelformat::format::argb1555,
+            "alpha of 0 and 255 is ARGB1555", 0);
+    }
+
+    {
+        std::vector<std::uint32_t> translucent(16, 0xff204080u);
+        translucent[3] = 0x00000000u;
+        translucent[5] = 0x80204080u;
+
+        surface s = argb(translucent);
+        t.expect(static_texture::reduced_format(s) == pixelformat::format::argb4444,
+            "partial alpha is ARGB4444", 0);
+    }
+
+    {
+        std::vector<std::uint32_t> rgb(16, 0x00204080u);
+        surface s(rgb.data(), 4, 4, 32, 4 * 4, rmask, gmask, bmask, 0);
+        t.expect(static_texture::reduced_format(s) == pixelformat::format::rgb565,
+            "no alpha channel is RGB565", 0);
+    }
+
+    return t.result();
+}
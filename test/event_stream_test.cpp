@@ -0,0 +1,96 @@
+#include "checks.hpp"
+
+#include "wsdl2/event_stream.hpp"
+
+#include <cstring>
+#include <vector>
+
+// every pushed event comes back with the same kind and payload
+int main() {
+
+    using namespace wsdl2;
+
+    test::checks t;
+
+    std::vector<SDL_Event> events(6);
+    for (SDL_Event& ev : events)
+        std::memset(&ev, 0, sizeof(SDL_Event));
+
+    events[0].key.type = SDL_KEYDOWN;
+    events[0].key.timestamp = 10;
+    events[0].key.windowID = 3;
+    events[0].key.keysym.scancode = SDL_SCANCODE_A;
+    events[0].key.keysym.sym = SDLK_a;
+
+    events[1].motion.type = SDL_MOUSEMOTION;
+    events[1].motion.timestamp = 11;
+    events[1].motion.x = 320;
+    events[1].motion.y = -12;
+    events[1].motion.xrel = 4;
+
+    events[2].window.type = SDL_WINDOWEVENT;
+    events[2].window.timestamp = 12;
+    events[2].window.event = SDL_WINDOWEVENT_SIZE_CHANGED;
+    events[2].window.data1 = 1024;
+    events[2].window.data2 = 768;
+
+    events[3].quit.type = SDL_QUIT;
+    events[3].quit.timestamp = 13;
+
+    events[4].user.type = SDL_USEREVENT + 7;
+    events[4].user.timestamp = 14;
+    events[4].user.code = 42;
+
+    // unassigned, between the render events and SDL_USEREVENT, so it is
+    // kept as a whole SDL_Event
+    events[5].common.type = 0x7000;
+    events[5].common.timestamp = 15;
+    events[5].user.code = 43;
+
+    const event::kind kinds[] = {
+        event::kind::key_down,
+        event::kind::mouse_motion,
+        event::kind::window,
+        event::kind::quit,
+        event::kind::user,
+        event::kind::unknown,
+    };
+
+    event::stream s;
+    for (const SDL_Event& ev : events)
+        s.push(ev);
+
+    t.expect(s.size() == events.size(), "event count");
+    t.expect(s.bytes() % sizeof(event::stream::word) == 0, "whole words");
+    t.expect(s.bytes() < events.size() * (sizeof(SDL_Event) + sizeof(event::stream::word)),
+        "packed smaller than the SDL_Event union");
+
+    std::size_t i = 0;
+    for (const auto record : s) {
+        if (i >= events.size()) {
+            t.expect(false, "iteration past the end");
+            break;
+        }
+
+        const SDL_Event& ev = events[i];
+        const SDL_Event back = record.sdl();
+
+        t.expect(record.type() == kinds[i], "kind");
+        t.expect(record.size() == event::payload_size(kinds[i]), "payload size");
+        t.expect(record.sdl_type() == ev.type, "type");
+        t.expect(record.timestamp() == ev.common.timestamp, "timestamp");
+        t.expect(std::memcmp(&back, &ev, record.size()) == 0, "payload");
+        i++;
+    }
+
+    t.expect(i == events.size(), "iterated events");
+
+    t.expect(event::payload_size(event::kind::unknown) == sizeof(SDL_Event), "unknown payload size");
+
+    t.expect((*s.begin()).as<SDL_KeyboardEvent>().keysym.scancode == SDL_SCANCODE_A, "as<T>()");
+
+    s.clear();
+    t.expect(s.empty() && s.begin() == s.end(), "clear");
+
+    return t.result();
+}
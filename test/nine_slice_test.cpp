@@ -0,0 +1,85 @@
+#include "checks.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// draws a texture made of nine solid regions on a canvas and checks that
+// every part of the frame lands where it should
+namespace {
+    // region (column, row) of the 6x6 texture, borders are 2 pixels
+    std::uint32_t region_color(int column, int row) {
+        return static_cast<std::uint32_t>(0xff000000u
+            | static_cast<std::uint32_t>(40 + 80 * column) << 16
+            | static_cast<std::uint32_t>(40 + 80 * row) << 8
+            | 0x80u);
+    }
+}
+
+int main() {
+
+    using namespace wsdl2;
+
+    test::checks t;
+
+    std::vector<std::uint32_t> pixels(36);
+    for (int y = 0; y < 6; y++) {
+        for (int x = 0; x < 6; x++)
+            pixels[static_cast<std::size_t>(y * 6 + x)] = region_color(x / 2, y / 2);
+    }
+
+    surface image(pixels.data(), 6, 6, 32, 6 * 4, test::rmask, test::gmask, test::bmask);
+
+    canvas c(20, 16);
+    renderer& r = c.get_renderer();
+    static_texture tex(r, image);
+
+    // nine-slice: 2 pixel borders, stretched edges and center
+    r.set_color(0, 0, 0, 255);
+    r.clear();
+    tex.render_nine_slice(rect {0, 0, 20, 16}, 2, 2, 2, 2);
+    r.present();
+
+    {
+        const auto out = test::read(c);
+        const int xs[] = {1, 10, 18};
+        const int ys[] = {1, 8, 14};
+
+        for (int row = 0; row < 3; row++) {
+            for (int column = 0; column < 3; column++) {
+                const int x = xs[column], y = ys[row];
+                t.expect(out[static_cast<std::size_t>(y * 20 + x)] == region_color(column, row),
+                    "nine-slice region", x, y);
+            }
+        }
+
+        // the borders keep their size
+        t.expect(out[0] == region_color(0, 0), "top left corner", 0, 0);
+        t.expect(out[2] == region_color(1, 0), "top edge starts after the border", 2, 0);
+        t.expect(out[17] == region_color(1, 0), "top edge ends before the border", 17, 0);
+        t.expect(out[18] == region_color(2, 0), "top right corner", 18, 0);
+        t.expect(out[15 * 20 + 19] == region_color(2, 2), "bottom right corner", 19, 15);
+    }
+
+    // tiled: the texture repeated at its size from the top left of dest
+    r.set_color(0, 0, 0, 255);
+    r.clear();
+    tex.render_tiled(rect {0, 0, 15, 15});
+    r.present();
+
+    {
+        const auto out = test::read(c);
+
+        for (int y = 0; y < 15; y++) {
+            for (int x = 0; x < 15; x++) {
+                const std::uint32_t expected = region_color((x % 6) / 2, (y % 6) / 2);
+                t.expect(out[static_cast<std::size_t>(y * 20 + x)] == expected, "tile", x, y);
+            }
+        }
+
+        // nothing outside of dest
+        t.expect(out[15] == 0xff000000u, "outside of dest", 15, 0);
+        t.expect(out[15 * 20] == 0xff000000u, "outside of dest", 0, 15);
+    }
+
+    return t.result();
+}
@@ -0,0 +1,134 @@
+#include "checks.hpp"
+
+#include "wsdl2/shapes.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// fills polygons on a canvas and checks that the triangulation covers the
+// inside and nothing else, then that moved shapes are drawn from the cache
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+namespace {
+    constexpr int size = 40;
+    constexpr std::uint32_t black = 0xff000000u;
+    constexpr std::uint32_t white = 0xffffffffu;
+
+    std::uint32_t at(const std::vector<std::uint32_t>& pixels, int x, int y) {
+        return pixels[static_cast<std::size_t>(y * size + x)];
+    }
+
+    // every pixel of the rectangle, one pixel away from its edges, is white
+    bool filled(const std::vector<std::uint32_t>& pixels, int x0, int y0, int x1, int y1) {
+        for (int y = y0 + 1; y < y1 - 1; y++) {
+            for (int x = x0 + 1; x < x1 - 1; x++) {
+                if (at(pixels, x, y) != white)
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::vector<wsdl2::fpoint> reversed(std::vector<wsdl2::fpoint> points) {
+        return std::vector<wsdl2::fpoint>(points.rbegin(), points.rend());
+    }
+}
+
+int main() {
+
+    using namespace wsdl2;
+
+    test::checks t;
+
+    canvas c(size, size);
+    renderer& r = c.get_renderer();
+    shapes s(r);
+
+    const color fill {255, 255, 255, 255};
+
+    auto draw = [&](const std::vector<fpoint>& points) {
+        r.set_color(0, 0, 0, 255);
+        r.clear();
+        s.fill_polygon(points, fill);
+        r.present();
+        return test::read(c);
+    };
+
+    const std::vector<fpoint> square {{5, 5}, {15, 5}, {15, 15}, {5, 15}};
+
+    // an L, concave at (15, 15)
+    const std::vector<fpoint> ell {{5, 5}, {25, 5}, {25, 15}, {15, 15}, {15, 35}, {5, 35}};
+
+    // the square with extra points along three of its edges
+    const std::vector<fpoint> collinear {
+        {5, 5}, {10, 5}, {15, 5}, {15, 10}, {15, 15}, {10, 15}, {5, 15}
+    };
+
+    for (const auto& points : {square, reversed(square)}) {
+        const auto out = draw(points);
+
+        t.expect(filled(out, 5, 5, 15, 15), "convex square is filled");
+        t.expect(at(out, 3, 10) == black && at(out, 17, 10) == black, "outside of the square");
+        t.expect(at(out, 10, 3) == black && at(out, 10, 17) == black, "outside of the square");
+    }
+
+    for (const auto& points : {ell, reversed(ell)}) {
+        const auto out = draw(points);
+
+        t.expect(filled(out, 5, 5, 25, 15), "arm of the L is filled");
+        t.expect(filled(out, 5, 15, 15, 35), "leg of the L is filled");
+        t.expect(at(out, 20, 20) == black && at(out, 23, 33) == black, "notch of the L is empty");
+        t.expect(at(out, 27, 10) == black && at(out, 10, 37) == black, "outside of the L");
+    }
+
+    for (const auto& points : {collinear, reversed(collinear)}) {
+        const auto out = draw(points);
+
+        t.expect(filled(out, 5, 5, 15, 15), "square with collinear points is filled");
+        t.expect(at(out, 17, 10) == black && at(out, 10, 17) == black, "outside of the square");
+    }
+
+    // the same shapes elsewhere come from the cache
+    {
+        shapes moved(r);
+
+        r.set_color(0, 0, 0, 255);
+        r.clear();
+        moved.fill_circle(fpoint {8, 8}, 5, fill);
+        moved.fill_circle(fpoint {30, 30}, 5, fill);
+        r.present();
+
+        t.expect(moved.misses() == 1 && moved.hits() == 1, "moved circle is cached");
+        t.expect(moved.size() == 1, "one tessellation for the circle");
+
+        const auto out = test::read(c);
+        t.expect(filled(out, 6, 6, 11, 11), "first circle");
+        t.expect(filled(out, 28, 28, 33, 33), "moved circle");
+        t.expect(at(out, 20, 20) == black, "between the circles");
+
+        std::vector<fpoint> shifted;
+        for (const fpoint& p : ell)
+            shifted.push_back(fpoint {p.x + 3, p.y + 2});
+
+        moved.fill_polygon(ell, fill);
+        moved.fill_polygon(shifted, fill);
+        t.expect(moved.misses() == 2 && moved.hits() == 2, "moved polygon is cached");
+
+        r.set_color(0, 0, 0, 255);
+        r.clear();
+        moved.fill_polygon(shifted, fill);
+        r.present();
+
+        const auto shifted_out = test::read(c);
+        t.expect(filled(shifted_out, 8, 7, 28, 17), "moved polygon is in place");
+        t.expect(at(shifted_out, 6, 10) == black, "moved polygon left its old place");
+    }
+
+    return t.result();
+}
+#else
+// no shapes before SDL_RenderGeometry
+int main() {
+    return 0;
+}
+#endif
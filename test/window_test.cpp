@@ -4,6 +4,8 @@
 #include "wsdl2/video.hpp"
 #include "wsdl2/event.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <type_traits>
 
@@ -16,9 +18,12 @@ int main() {
     auto win = std::make_unique<window>("Window Test", 800, 600);
     win->open();
 
+    const auto frame_time = std::chrono::microseconds(1000000 / 60);
+    auto next_frame = event::clock::now() + frame_time;
+
     do {
-        auto event = event::poll();
-        if (event) {
+        // handle events until the next frame is due
+        while (auto event = event::wait_until(next_frame)) {
             std::visit([&](auto& e) {
                 using T = std::decay_t<decltype(e)>;
                 
@@ -47,8 +52,8 @@ int main() {
 
         win->clear();
         win->present();
-        // ~60 fps test
-        wsdl2::delay(static_cast<unsigned>(1000.0/60.0));
+        // ~60 fps test, without falling behind when a frame is late
+        next_frame = std::max(next_frame + frame_time, event::clock::now());
     } while (win->is_open());
 
     win.reset();
@@ -0,0 +1,233 @@
+#include "wsdl2/tilemap.hpp"
+#include "wsdl2/debug.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace wsdl2;
+
+// rounds towards negative infinity, the camera may be left of the map
+static int floor_div(int a, int b) {
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+tilemap::tilemap(renderer& r, texture& atlas, int tile_width, int tile_height,
+    int columns, int rows, int chunk_size /* = 16 */, std::size_t memory_budget /* = 64 << 20 */)
+    : m_renderer(r),
+      m_atlas(atlas),
+      m_tile_width(tile_width),
+      m_tile_height(tile_height),
+      m_columns(columns),
+      m_rows(rows),
+      m_chunk_size(chunk_size),
+      m_capacity(std::max<std::size_t>(memory_budget / std::max<std::size_t>(
+          static_cast<std::size_t>(chunk_size) * static_cast<std::size_t>(chunk_size)
+          * static_cast<std::size_t>(tile_width) * static_cast<std::size_t>(tile_height) * 4, 1), 1)),
+      m_chunk_columns((columns + chunk_size - 1) / std::max(chunk_size, 1)),
+      m_chunk_rows((rows + chunk_size - 1) / std::max(chunk_size, 1)),
+      m_tiles(static_cast<std::size_t>(columns) * static_cast<std::size_t>(rows), empty),
+      m_chunks(static_cast<std::size_t>(m_chunk_columns) * static_cast<std::size_t>(m_chunk_rows))
+{
+    if (tile_width <= 0 || tile_height <= 0 || chunk_size <= 0) {
+        throw std::invalid_argument("tilemap needs positive tile and chunk sizes");
+    }
+}
+
+point tilemap::chunk_size(int cx, int cy) const {
+    return point {
+        std::min(m_chunk_size, m_columns - cx * m_chunk_size) * m_tile_width,
+        std::min(m_chunk_size, m_rows - cy * m_chunk_size) * m_tile_height
+    };
+}
+
+void tilemap::set(int x, int y, tile t) {
+    tile& current = m_tiles[static_cast<std::size_t>(y * m_columns + x)];
+    if (current == t)
+        return;
+
+    chunk& c = chunk_at(x / m_chunk_size, y / m_chunk_size);
+
+    if (current == empty)
+        c.filled++;
+    else if (t == empty)
+        c.filled--;
+
+    current = t;
+    c.dirty = true;
+}
+
+void tilemap::fill(tile t) {
+    std::fill(m_tiles.begin(), m_tiles.end(), t);
+
+    for (int cy = 0; cy < m_chunk_rows; cy++) {
+        for (int cx = 0; cx < m_chunk_columns; cx++) {
+            const point size = chunk_size(cx, cy);
+            chunk_at(cx, cy).filled = (t == empty) ? 0
+                : (size.x / m_tile_width) * (size.y / m_tile_height);
+        }
+    }
+
+    invalidate();
+}
+
+void tilemap::invalidate() {
+    for (chunk& c : m_chunks)
+        c.dirty = true;
+}
+
+void tilemap::release(chunk& c) {
+    if (!c.tex)
+        return;
+
+    m_baked.erase(c.lru);
+    c.tex.reset();
+}
+
+bool tilemap::bake(int cx, int cy) {
+    wsdl2_profile_zone("tilemap::bake");
+
+    chunk& c = chunk_at(cx, cy);
+    const point size = chunk_size(cx, cy);
+
+    if (!c.tex) {
+        std::unique_ptr<target_texture> tex;
+
+        if (m_baked.size() >= m_capacity) {
+            // the drawn chunks are in front, if the last one is drawn so are all
+            chunk& last = m_chunks[m_baked.back()];
+            if (last.frame == m_frame)
+                return false;
+
+            tex = std::move(last.tex);
+            m_baked.pop_back();
+
+            // chunks on the edges of the map are smaller
+            if (tex->width() != size.x || tex->height() != size.y)
+                tex.reset();
+        }
+
+        if (!tex) {
+            tex = std::make_unique<target_texture>(m_renderer, size.x, size.y,
+                pixelformat::format::argb8888
+            );
+
+            // same as the layers, baked colors are already premultiplied
+            if (!tex->blend(blend_mode::premultiplied))
+                tex->blend(blend_mode::blend);
+        }
+
+        c.tex = std::move(tex);
+        m_baked.push_front(static_cast<std::size_t>(cy * m_chunk_columns + cx));
+        c.lru = m_baked.begin();
+    }
+
+    const int first_x = cx * m_chunk_size;
+    const int first_y = cy * m_chunk_size;
+    const int count_x = size.x / m_tile_width;
+    const int count_y = size.y / m_tile_height;
+
+    const color previous = m_renderer.get_color();
+
+    c.tex->set_target();
+    m_renderer.set_color(0, 0, 0, 0);
+    m_renderer.clear();
+    m_renderer.set_color(previous);
+
+    const int atlas_columns = std::max(m_atlas.width() / m_tile_width, 1);
+
+    for (int y = 0; y < count_y; y++) {
+        for (int x = 0; x < count_x; x++) {
+            const tile t = at(first_x + x, first_y + y);
+            if (t == empty)
+                continue;
+
+            rect src {
+                (t % atlas_columns) * m_tile_width,
+                (t / atlas_columns) * m_tile_height,
+                m_tile_width, m_tile_height
+            };
+
+            m_atlas.render(src, rect {
+                x * m_tile_width, y * m_tile_height,
+                m_tile_width, m_tile_height
+            });
+        }
+    }
+
+    // same as the layers
+    if (c.tex->blend() != blend_mode::premultiplied)
+        c.tex->unpremultiply();
+
+    c.dirty = false;
+    return true;
+}
+
+void tilemap::render(const point& camera) {
+    wsdl2_profile_zone("tilemap::render");
+
+    m_frame++;
+    m_drawn = 0;
+    m_missing = 0;
+
+    // in viewport coordinates, so only its size matters
+    const rect view = m_renderer.viewport();
+    const int chunk_width = m_chunk_size * m_tile_width;
+    const int chunk_height = m_chunk_size * m_tile_height;
+
+    const int cx0 = std::max(floor_div(camera.x, chunk_width), 0);
+    const int cy0 = std::max(floor_div(camera.y, chunk_height), 0);
+    const int cx1 = std::min(floor_div(camera.x + view.w - 1, chunk_width), m_chunk_columns - 1);
+    const int cy1 = std::min(floor_div(camera.y + view.h - 1, chunk_height), m_chunk_rows - 1);
+
+    if (cx0 > cx1 || cy0 > cy1)
+        return;
+
+    // bake first, to switch back to the previous target only once
+    const renderer::saved_target previous = m_renderer.target();
+    bool baked = false;
+
+    for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+            chunk& c = chunk_at(cx, cy);
+
+            // nothing to draw
+            if (c.filled == 0) {
+                release(c);
+                continue;
+            }
+
+            if (c.dirty || !c.tex) {
+                if (!bake(cx, cy)) {
+                    m_missing++;
+                    continue;
+                }
+
+                baked = true;
+            }
+
+            // keeps it from being evicted by the next chunks of this frame
+            m_baked.splice(m_baked.begin(), m_baked, c.lru);
+            c.frame = m_frame;
+        }
+    }
+
+    if (baked)
+        m_renderer.restore_target(previous);
+
+    for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+            chunk& c = chunk_at(cx, cy);
+            if (!c.tex || c.frame != m_frame)
+                continue;
+
+            rect src {0, 0, c.tex->width(), c.tex->height()};
+            c.tex->render(src, rect {
+                cx * chunk_width - camera.x,
+                cy * chunk_height - camera.y,
+                c.tex->width(), c.tex->height()
+            });
+
+            m_drawn++;
+        }
+    }
+}
@@ -0,0 +1,84 @@
+#include "wsdl2/timing.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace wsdl2;
+
+void timing::sleep_until(std::uint64_t deadline, double spin) {
+    const std::uint64_t margin = ticks(spin);
+    std::uint64_t t = now();
+
+    // SDL_Delay has millisecond granularity and may oversleep
+    if (t + margin < deadline) {
+        double left = seconds(deadline - margin - t);
+        auto ms = static_cast<Uint32>(left * 1000.0);
+
+        if (ms > 0)
+            SDL_Delay(ms);
+    }
+
+    while (now() < deadline) {
+        // spin
+    }
+}
+
+frame_clock::frame_clock(double fps, double step_rate)
+    : m_period(timing::ticks(1.0 / fps)),
+      m_timestep(1.0 / step_rate),
+      m_max_elapsed(std::max(0.25, 4.0 / step_rate)),
+      m_deadline(timing::now() + m_period),
+      m_last_tick(timing::now()),
+      m_last_frame(timing::now())
+{}
+
+void frame_clock::tick() {
+    std::uint64_t t = timing::now();
+    double elapsed = timing::seconds(t - m_last_tick);
+    m_last_tick = t;
+
+    m_accumulator += std::min(elapsed, m_max_elapsed);
+}
+
+bool frame_clock::step() {
+    if (m_accumulator < m_timestep)
+        return false;
+
+    m_accumulator -= m_timestep;
+    return true;
+}
+
+void frame_clock::wait() {
+    if (timing::now() > m_deadline) {
+        // late, start counting from now instead of catching up
+        m_stats.missed++;
+        m_deadline = timing::now();
+    } else {
+        timing::sleep_until(m_deadline, m_spin);
+    }
+
+    std::uint64_t t = timing::now();
+    m_frame_time = timing::seconds(t - m_last_frame);
+    m_last_frame = t;
+    m_deadline += m_period;
+
+    // update statistics
+    m_stats.frames++;
+    if (m_stats.frames == 1) {
+        m_stats.min = m_frame_time;
+        m_stats.max = m_frame_time;
+    } else {
+        m_stats.min = std::min(m_stats.min, m_frame_time);
+        m_stats.max = std::max(m_stats.max, m_frame_time);
+    }
+
+    double delta = m_frame_time - m_stats.mean;
+    m_stats.mean += delta / static_cast<double>(m_stats.frames);
+    m_m2 += delta * (m_frame_time - m_stats.mean);
+    m_stats.jitter = std::sqrt(m_m2 / static_cast<double>(m_stats.frames));
+}
+
+void frame_clock::reset_statistics() {
+    m_stats = stats();
+    m_m2 = 0;
+}
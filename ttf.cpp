@@ -9,7 +9,7 @@ using namespace wsdl2::ttf;
 font::font(const std::string& path, int ptsize) {
     m_font = TTF_OpenFont(path.c_str(), ptsize);
 
-    if (util::check_ttf(m_font != NULL)) {
+    if (!util::check_ttf(m_font != NULL)) {
         throw std::runtime_error("failed to load font: " + path);
     }
 }
@@ -17,7 +17,7 @@ font::font(const std::string& path, int ptsize) {
 font::font(const std::string& path, int ptsize, long index) {
     m_font = TTF_OpenFontIndex(path.c_str(), ptsize, index);
 
-    if (util::check_ttf(m_font != NULL)) {
+    if (!util::check_ttf(m_font != NULL)) {
         throw std::runtime_error("failed to load font: " + path);
     }
 }
@@ -1,7 +1,11 @@
 #include "wsdl2/video.hpp"
 #include "wsdl2/debug.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <exception>
+#include <stdexcept>
 
 extern "C" {
 #include <SDL2/SDL.h>
@@ -15,6 +19,8 @@ using namespace wsdl2;
 
 /* class surface */
 
+std::atomic<std::uint64_t> surface::_created {0};
+
 surface::surface(surface&& other) {
     npdebug("moved surface");
     m_surface = other.m_surface;
@@ -34,6 +40,7 @@ surface::surface(std::size_t width, std::size_t height, int depth /* = 24 */,
         throw std::runtime_error("failed to create SDL_Surface");
     }
 
+    _created++;
     npdebug("created surface");
 }
 
@@ -49,6 +56,7 @@ surface::surface(void *pixels, std::size_t width, std::size_t height, int depth,
         throw std::runtime_error("failed to create SDL_Surface from pixels");
     }
 
+    _created++;
     npdebug("crated surface from pixels");
 }
 
@@ -60,6 +68,7 @@ surface::surface(SDL_Surface* surf)
     }
 
     m_surface = surf;
+    _created++;
     npdebug("created surface from ptr");
 }
 
@@ -98,6 +107,8 @@ SDL_Surface* surface::sdl() const {
 
 std::optional<surface> surface::load(const std::string& path)
 {
+    wsdl2_profile_zone("surface::load");
+
     SDL_Surface* surf = 
 
 #ifdef WSDL2_IMG
@@ -114,24 +125,389 @@ std::optional<surface> surface::load(const std::string& path)
 
 
 
+#ifndef WSDL2_THREADS
+// without the job system the rows are processed by the calling thread
+void jobs::parallel_rows(surface& s, const std::function<void(void *, int)>& f,
+    int /* rows_per_job = 16 */)
+{
+    s.lock();
+
+    auto *pixels = static_cast<std::uint8_t*>(s.sdl()->pixels);
+    const auto pitch = static_cast<std::size_t>(s.sdl()->pitch);
+
+    try {
+        for (int y = 0; y < s.height(); y++)
+            f(pixels + static_cast<std::size_t>(y) * pitch, y);
+    } catch (...) {
+        s.unlock();
+        throw;
+    }
+
+    s.unlock();
+}
+#endif
+
+bool surface::premultiply()
+{
+    wsdl2_profile_zone("surface::premultiply");
+
+    // nothing to do without an alpha channel
+    if (sdl()->format->Amask == 0)
+        return true;
+
+    if (sdl()->format->format != SDL_PIXELFORMAT_ARGB8888) {
+        SDL_Surface *converted = SDL_ConvertSurfaceFormat(sdl(), SDL_PIXELFORMAT_ARGB8888, 0);
+        if (!util::check(converted != NULL))
+            return false;
+
+        SDL_FreeSurface(m_surface);
+        m_surface = converted;
+    }
+
+    lock();
+
+    auto *row = static_cast<std::uint8_t *>(sdl()->pixels);
+    for (int y = 0; y < height(); y++, row += sdl()->pitch) {
+        auto *px = reinterpret_cast<std::uint32_t *>(row);
+
+        for (int x = 0; x < width(); x++) {
+            const std::uint32_t p = px[x];
+            const std::uint32_t a = p >> 24;
+
+            // exact rounding of c * a / 255
+            auto mul = [a](std::uint32_t c) {
+                const std::uint32_t t = c * a + 128;
+                return (t + (t >> 8)) >> 8;
+            };
+
+            px[x] = (a << 24)
+                | (mul((p >> 16) & 0xff) << 16)
+                | (mul((p >> 8) & 0xff) << 8)
+                | mul(p & 0xff);
+        }
+    }
+
+    unlock();
+    return true;
+}
+
+
+
+namespace {
+    // bits and shifts of the 16 bit formats, alpha is 0 bits when opaque
+    struct packing {
+        int bits[4];
+        int shifts[4];
+    };
+
+    std::optional<packing> packing_of(pixelformat::format f) {
+        if (f == pixelformat::format::rgb565)
+            return packing {{5, 6, 5, 0}, {11, 5, 0, 0}};
+        if (f == pixelformat::format::argb4444)
+            return packing {{4, 4, 4, 4}, {8, 4, 0, 12}};
+        if (f == pixelformat::format::argb1555)
+            return packing {{5, 5, 5, 1}, {10, 5, 0, 15}};
+
+        return std::nullopt;
+    }
+
+    // 4x4 Bayer matrix, thresholds 0 to 15
+    constexpr int bayer[4][4] = {
+        { 0,  8,  2, 10},
+        {12,  4, 14,  6},
+        { 3, 11,  1,  9},
+        {15,  7, 13,  5},
+    };
+
+    // v * levels / 255 rounded with a threshold t / 16 instead of one half
+    inline int quantize(int v, int levels, int t) {
+        return std::min((v * levels * 32 + (2 * t + 1) * 255) / (255 * 32), levels);
+    }
+
+    inline int expand(int q, int levels) {
+        return (q * 255 + levels / 2) / levels;
+    }
+
+    // channels of an ARGB8888 pixel in r, g, b, a order
+    inline std::array<int, 4> channels(std::uint32_t p) {
+        return {{
+            static_cast<int>((p >> 16) & 0xff), static_cast<int>((p >> 8) & 0xff),
+            static_cast<int>(p & 0xff), static_cast<int>(p >> 24)
+        }};
+    }
+
+    void dither_ordered(SDL_Surface *src, SDL_Surface *dest, const packing& pk) {
+        for (int y = 0; y < src->h; y++) {
+            const auto *in = reinterpret_cast<const std::uint32_t *>(
+                static_cast<const std::uint8_t *>(src->pixels) + y * src->pitch);
+            auto *out = reinterpret_cast<std::uint16_t *>(
+                static_cast<std::uint8_t *>(dest->pixels) + y * dest->pitch);
+
+            for (int x = 0; x < src->w; x++) {
+                const auto c = channels(in[x]);
+                const int t = bayer[y & 3][x & 3];
+
+                unsigned packed = 0;
+                for (int i = 0; i < 4; i++) {
+                    if (pk.bits[i] == 0)
+                        continue;
+
+                    const int levels = (1 << pk.bits[i]) - 1;
+                    packed |= static_cast<unsigned>(quantize(c[i], levels, t)) << pk.shifts[i];
+                }
+
+                out[x] = static_cast<std::uint16_t>(packed);
+            }
+        }
+    }
+
+    void dither_diffusion(SDL_Surface *src, SDL_Surface *dest, const packing& pk) {
+        // errors of the current and the next row, in 1/16 of a unit and
+        // with a guard pixel on both sides
+        const std::size_t stride = static_cast<std::size_t>(src->w) + 2;
+        std::vector<int> current(stride * 3, 0), next(stride * 3, 0);
+
+        for (int y = 0; y < src->h; y++) {
+            const auto *in = reinterpret_cast<const std::uint32_t *>(
+                static_cast<const std::uint8_t *>(src->pixels) + y * src->pitch);
+            auto *out = reinterpret_cast<std::uint16_t *>(
+                static_cast<std::uint8_t *>(dest->pixels) + y * dest->pitch);
+
+            std::fill(next.begin(), next.end(), 0);
+
+            for (int x = 0; x < src->w; x++) {
+                const auto c = channels(in[x]);
+                unsigned packed = 0;
+
+                for (int i = 0; i < 3; i++) {
+                    const int levels = (1 << pk.bits[i]) - 1;
+                    const std::size_t at = static_cast<std::size_t>(i) * stride
+                        + static_cast<std::size_t>(x) + 1;
+
+                    // kept in 1/16, so that no part of the error is lost
+                    const int v = std::clamp(c[i] * 16 + current[at], 0, 255 * 16);
+                    const int q = (v * levels + 255 * 8) / (255 * 16);
+                    const int error = v - expand(q, levels) * 16;
+
+                    const int right = error * 7 / 16;
+                    const int below_left = error * 3 / 16;
+                    const int below = error * 5 / 16;
+
+                    current[at + 1] += right;
+                    next[at - 1] += below_left;
+                    next[at] += below;
+                    next[at + 1] += error - right - below_left - below;
+
+                    packed |= static_cast<unsigned>(q) << pk.shifts[i];
+                }
+
+                // spreading the alpha would fringe the edges, it is rounded
+                if (pk.bits[3] > 0) {
+                    const int levels = (1 << pk.bits[3]) - 1;
+                    packed |= static_cast<unsigned>((c[3] * levels + 127) / 255) << pk.shifts[3];
+                }
+
+                out[x] = static_cast<std::uint16_t>(packed);
+            }
+
+            std::swap(current, next);
+        }
+    }
+}
+
+bool surface::convert(pixelformat::format f, dither d /* = dither::none */)
+{
+    wsdl2_profile_zone("surface::convert");
+
+    const auto pk = packing_of(f);
+    const bool reduced = pk && d != dither::none;
+
+    // dithering reads ARGB8888 pixels
+    const Uint32 first = reduced ? static_cast<Uint32>(SDL_PIXELFORMAT_ARGB8888)
+                                 : static_cast<Uint32>(f);
+
+    if (sdl()->format->format != first) {
+        SDL_Surface *converted = SDL_ConvertSurfaceFormat(sdl(), first, 0);
+        if (!util::check(converted != NULL))
+            return false;
+
+        SDL_FreeSurface(m_surface);
+        m_surface = converted;
+    }
+
+    if (!reduced)
+        return true;
+
+    SDL_Surface *out = SDL_CreateRGBSurfaceWithFormat(0, width(), height(), 16,
+        static_cast<Uint32>(f));
+    if (!util::check(out != NULL))
+        return false;
+
+    if (d == dither::automatic)
+        d = (pk->bits[3] == 0) ? dither::diffusion : dither::ordered;
+
+    lock();
+    if (d == dither::diffusion)
+        dither_diffusion(sdl(), out, *pk);
+    else
+        dither_ordered(sdl(), out, *pk);
+    unlock();
+
+    SDL_FreeSurface(m_surface);
+    m_surface = out;
+    return true;
+}
+
 /* class Renderer */
 
 renderer::renderer() {
     npdebug("warning: created uninitialized renderer object");
 }
 
-renderer::renderer(renderer&& other) {
-    m_renderer = std::move(other.m_renderer);
+renderer::renderer(renderer&& other)
+    : m_color(other.m_color),
+      m_blend(other.m_blend),
+      m_target(other.m_target),
+      m_viewport(other.m_viewport),
+      m_clip(other.m_clip),
+      m_culling(other.m_culling),
+      m_bounds(other.m_bounds)
+{
+    m_renderer = other.m_renderer;
+    other.m_renderer = NULL;
 }
 
 bool renderer::set_target(texture& target) {
     if (target.pixel_access() != texture::access::target)
         return false;
 
-    util::check(0 == SDL_SetRenderTarget(sdl(), target.sdl()));
+    switch_target(target.sdl());
     return true;
 }
 
+void renderer::switch_target(SDL_Texture *target) {
+    if (target == m_target)
+        return;
+
+    m_stats.target_switches++;
+    if (util::check(0 == SDL_SetRenderTarget(sdl(), target))) {
+        m_target = target;
+        // SDL resets (or restores) viewport and clipping with the target
+        load_state();
+    }
+}
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+void renderer::render_geometry(const vertex *vertices, int vertex_count,
+    const int *indices /* = nullptr */, int index_count /* = 0 */, texture *t /* = nullptr */)
+{
+    wsdl2_profile_zone("renderer::render_geometry");
+
+    if (vertex_count <= 0)
+        return;
+
+    SDL_Texture *tex = (t != nullptr) ? t->sdl() : NULL;
+    if (tex != NULL)
+        count_copy(tex);
+    else
+        count(m_stats.geometry);
+
+    util::check(0 == SDL_RenderGeometry(sdl(), tex, vertices, vertex_count, indices, index_count));
+}
+#endif
+
+void renderer::update_bounds() {
+    m_bounds = rect {0, 0, m_viewport.w, m_viewport.h};
+
+    // the clip rectangle is relative to the viewport
+    if (m_clip) {
+        if (auto visible = m_bounds.intersection(*m_clip))
+            m_bounds = *visible;
+        else
+            m_bounds = rect {0, 0, 0, 0};
+    }
+}
+
+bool renderer::culled(const rect& dest, const point& center, double angle) {
+    if (!m_culling)
+        return false;
+
+    // unrotated within rounding, the rectangle itself is the bound
+    if (std::fabs(std::remainder(angle, 360.0)) < 1e-9)
+        return culled(dest);
+
+    // the rotated rectangle stays within the circle around the pivot
+    // that passes through its farthest corner
+    const long dx = std::max<long>(center.x, dest.w - center.x);
+    const long dy = std::max<long>(center.y, dest.h - center.y);
+    const int radius = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(dx * dx + dy * dy))));
+
+    return culled(rect {
+        dest.x + center.x - radius, dest.y + center.y - radius,
+        2 * radius, 2 * radius
+    });
+}
+
+bool renderer::supports(blend_mode m) {
+    const blend_mode previous = m_blend;
+    if (!blend(m))
+        return false;
+
+    blend(previous);
+    return true;
+}
+
+bool renderer::logical_size(int width, int height) {
+    if (!util::check(0 == SDL_RenderSetLogicalSize(sdl(), width, height)))
+        return false;
+
+    load_state();
+    return true;
+}
+
+bool renderer::scale(float x, float y) {
+    if (!util::check(0 == SDL_RenderSetScale(sdl(), x, y)))
+        return false;
+
+    load_state();
+    return true;
+}
+
+void renderer::load_state() {
+    util::check(0 == SDL_GetRenderDrawColor(sdl(),
+        &m_color.r, &m_color.g, &m_color.b, &m_color.a));
+
+    SDL_BlendMode mode;
+    if (util::check(0 == SDL_GetRenderDrawBlendMode(sdl(), &mode)))
+        m_blend = to_blend_mode(mode);
+
+    SDL_RenderGetViewport(sdl(), &m_viewport);
+
+    if (SDL_RenderIsClipEnabled(sdl())) {
+        rect r;
+        SDL_RenderGetClipRect(sdl(), &r);
+        m_clip = r;
+    } else {
+        m_clip.reset();
+    }
+
+    update_bounds();
+}
+
+void renderer::end_frame_stats() {
+    const std::uint64_t surfaces = surface::created();
+    const std::uint64_t failures = util::check_failures;
+
+    m_stats.surfaces_created = surfaces - m_surfaces_base;
+    m_stats.check_failures = failures - m_failures_base;
+    m_surfaces_base = surfaces;
+    m_failures_base = failures;
+
+    m_last_stats = m_stats;
+    m_stats = render_stats();
+    m_bound = NULL;
+}
+
 SDL_Renderer * renderer::sdl() {
 #ifdef DEBUG
     if (m_renderer == NULL) {
@@ -144,22 +520,96 @@ SDL_Renderer * renderer::sdl() {
     return m_renderer;
 }
 
-renderer::renderer(SDL_Window *win)  {
-    // create a rendering contest
-    m_renderer = SDL_CreateRenderer(
-        win, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC
-    );
+static Uint32 renderer_flags(const renderer_config& config) {
+    Uint32 flags = 0;
+
+    switch (config.type) {
+    case renderer_config::backend::accelerated:
+        flags |= SDL_RENDERER_ACCELERATED;
+        break;
+
+    case renderer_config::backend::software:
+        flags |= SDL_RENDERER_SOFTWARE;
+        break;
+
+    case renderer_config::backend::any:
+        break;
+    }
+
+    if (config.vsync)
+        flags |= SDL_RENDERER_PRESENTVSYNC;
+
+    if (config.target_texture)
+        flags |= SDL_RENDERER_TARGETTEXTURE;
+
+    return flags;
+}
+
+// index of a render driver by name, -1 if not compiled into SDL
+static int find_driver(const std::string& name) {
+    const int count = SDL_GetNumRenderDrivers();
+
+    for (int i = 0; i < count; i++) {
+        SDL_RendererInfo info;
+        if (SDL_GetRenderDriverInfo(i, &info) == 0 && name == info.name)
+            return i;
+    }
+
+    return -1;
+}
+
+renderer::renderer(SDL_Window *win, const renderer_config& config)  {
+    const Uint32 flags = renderer_flags(config);
+
+    // create a rendering contest, trying the requested drivers first
+    for (const std::string& name : config.drivers) {
+        const int index = find_driver(name);
+        if (index < 0) {
+            npdebug("render driver ", name, " is not available");
+            continue;
+        }
+
+        m_renderer = SDL_CreateRenderer(win, index, flags);
+        if (m_renderer)
+            break;
+
+        npdebug("failed to create ", name, " renderer: ", SDL_GetError());
+    }
+
+    if (!m_renderer)
+        m_renderer = SDL_CreateRenderer(win, -1, flags);
+
+    // headless video drivers (dummy, offscreen) have no accelerated renderer
+    if (!m_renderer && config.fallback_software) {
+        npdebug("falling back to the software renderer");
+        m_renderer = SDL_CreateRenderer(win, -1,
+            SDL_RENDERER_SOFTWARE | (flags & SDL_RENDERER_TARGETTEXTURE)
+        );
+    }
 
     if (!m_renderer) {
         throw std::runtime_error("failed to create SDL renderer");
     }
+
+    load_state();
 }
 
-renderer::renderer(window& w) {
-    renderer(w.sdl());
+renderer::renderer(window& w) : renderer(w.sdl(), renderer_config()) {
     npdebug("created renderer from window");
 }
 
+renderer::renderer(surface& target) {
+    m_renderer = SDL_CreateSoftwareRenderer(target.sdl());
+
+    if (!m_renderer) {
+        throw std::runtime_error("failed to create SDL software renderer");
+    }
+
+    load_state();
+
+    npdebug("created software renderer from surface");
+}
+
 renderer::~renderer() {
     if (m_renderer != NULL) {
         SDL_DestroyRenderer(m_renderer);
@@ -167,6 +617,42 @@ renderer::~renderer() {
     }
 }
 
+renderer_info renderer::info() const
+{
+    renderer_info out;
+    SDL_RendererInfo raw;
+
+    if (!util::check(0 == SDL_GetRendererInfo(const_cast<SDL_Renderer*>(m_renderer), &raw)))
+        return out;
+
+    out.name = raw.name;
+    out.software = raw.flags & SDL_RENDERER_SOFTWARE;
+    out.accelerated = raw.flags & SDL_RENDERER_ACCELERATED;
+    out.vsync = raw.flags & SDL_RENDERER_PRESENTVSYNC;
+    out.target_texture = raw.flags & SDL_RENDERER_TARGETTEXTURE;
+    out.max_texture_width = raw.max_texture_width;
+    out.max_texture_height = raw.max_texture_height;
+
+    for (Uint32 i = 0; i < raw.num_texture_formats; i++)
+        out.formats.push_back(static_cast<pixelformat::format>(raw.texture_formats[i]));
+
+    return out;
+}
+
+std::vector<std::string> renderer::drivers()
+{
+    std::vector<std::string> names;
+    const int count = SDL_GetNumRenderDrivers();
+
+    for (int i = 0; i < count; i++) {
+        SDL_RendererInfo info;
+        if (util::check(0 == SDL_GetRenderDriverInfo(i, &info)))
+            names.emplace_back(info.name);
+    }
+
+    return names;
+}
+
 wsdl2::point renderer::size() const
 {
     point out;
@@ -177,13 +663,139 @@ wsdl2::point renderer::size() const
 
 /* class texture */
 
+namespace {
+    struct quad {
+        rect src;
+        rect dest;
+    };
+}
+
+struct texture::geometry {
+    // what the quads were built for
+    bool valid = false;
+    rect dest {0, 0, 0, 0};
+    std::array<int, 4> params {{0, 0, 0, 0}};
+    color mod {0, 0, 0, 0};
+
+    std::vector<quad> quads;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+#endif
+
+    inline bool matches(const rect& d, const std::array<int, 4>& p, const color& m) const {
+        return valid && dest == d && params == p
+            && mod.r == m.r && mod.g == m.g && mod.b == m.b && mod.a == m.a;
+    }
+
+    void build(const rect& d, const std::array<int, 4>& p, const color& m,
+        int tex_width, int tex_height)
+    {
+        valid = true;
+        dest = d;
+        params = p;
+        mod = m;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        const float u = 1.0f / static_cast<float>(tex_width);
+        const float v = 1.0f / static_cast<float>(tex_height);
+
+        vertices.clear();
+        indices.clear();
+
+        for (const quad& q : quads) {
+            const int base = static_cast<int>(vertices.size());
+
+            const float x0 = static_cast<float>(q.dest.x);
+            const float y0 = static_cast<float>(q.dest.y);
+            const float x1 = static_cast<float>(q.dest.x + q.dest.w);
+            const float y1 = static_cast<float>(q.dest.y + q.dest.h);
+
+            const float s0 = static_cast<float>(q.src.x) * u;
+            const float t0 = static_cast<float>(q.src.y) * v;
+            const float s1 = static_cast<float>(q.src.x + q.src.w) * u;
+            const float t1 = static_cast<float>(q.src.y + q.src.h) * v;
+
+            vertices.push_back(SDL_Vertex {{x0, y0}, m, {s0, t0}});
+            vertices.push_back(SDL_Vertex {{x1, y0}, m, {s1, t0}});
+            vertices.push_back(SDL_Vertex {{x1, y1}, m, {s1, t1}});
+            vertices.push_back(SDL_Vertex {{x0, y1}, m, {s0, t1}});
+
+            for (int i : {0, 1, 2, 0, 2, 3})
+                indices.push_back(base + i);
+        }
+#else
+        (void) tex_width;
+        (void) tex_height;
+#endif
+    }
+};
+
+static void nine_slice_quads(std::vector<quad>& out,
+    int tex_width, int tex_height, const rect& dest, int left, int top, int right, int bottom)
+{
+    // borders larger than the destination are scaled down
+    int dl = left, dr = right, dt = top, db = bottom;
+
+    if (dl + dr > dest.w && left + right > 0) {
+        dl = dest.w * left / (left + right);
+        dr = dest.w - dl;
+    }
+
+    if (dt + db > dest.h && top + bottom > 0) {
+        dt = dest.h * top / (top + bottom);
+        db = dest.h - dt;
+    }
+
+    const int sx[4] = {0, left, tex_width - right, tex_width};
+    const int sy[4] = {0, top, tex_height - bottom, tex_height};
+    const int dx[4] = {dest.x, dest.x + dl, dest.x + dest.w - dr, dest.x + dest.w};
+    const int dy[4] = {dest.y, dest.y + dt, dest.y + dest.h - db, dest.y + dest.h};
+
+    out.clear();
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            rect src {sx[j], sy[i], sx[j + 1] - sx[j], sy[i + 1] - sy[i]};
+            rect dst {dx[j], dy[i], dx[j + 1] - dx[j], dy[i + 1] - dy[i]};
+
+            if (src.w > 0 && src.h > 0 && dst.w > 0 && dst.h > 0)
+                out.push_back(quad {src, dst});
+        }
+    }
+}
+
+static void tiled_quads(std::vector<quad>& out,
+    int tex_width, int tex_height, const rect& dest)
+{
+    out.clear();
+    for (int y = dest.y; y < dest.y + dest.h; y += tex_height) {
+        const int h = std::min(tex_height, dest.y + dest.h - y);
+
+        for (int x = dest.x; x < dest.x + dest.w; x += tex_width) {
+            // the last row and column are cut, not scaled
+            const int w = std::min(tex_width, dest.x + dest.w - x);
+            out.push_back(quad {rect {0, 0, w, h}, rect {x, y, w, h}});
+        }
+    }
+}
+
 texture::texture(renderer& r, texture::access a, int width, int height, pixelformat::format p)
     : m_renderer(r), m_width(width), m_height(height), m_format(p)
 {
+    // SDL cannot create textures without a format
+    if (m_format == pixelformat::format::unknown)
+        m_format = pixelformat::format::argb8888;
+
     m_texture = SDL_CreateTexture(r.m_renderer, 
         static_cast<Uint32>(m_format), static_cast<int>(a), 
         static_cast<int>(m_width), static_cast<int>(m_height)
     );
+
+    if (!util::check(m_texture != NULL)) {
+        throw std::runtime_error("failed to create SDL texture");
+    }
+
+    load_state();
 }
 
 texture::texture(texture&& other)
@@ -191,7 +803,12 @@ texture::texture(texture&& other)
       m_width(other.m_width), 
       m_height(other.m_height),
       m_format(other.m_format),
-      m_texture(other.m_texture)
+      m_texture(other.m_texture),
+      m_alpha(other.m_alpha),
+      m_color_mod(other.m_color_mod),
+      m_blend(other.m_blend),
+      m_nine_slice(std::move(other.m_nine_slice)),
+      m_tiled(std::move(other.m_tiled))
 {
     other.m_texture = nullptr;
 }
@@ -221,21 +838,155 @@ texture::texture(renderer& r, surface& surf, pixelformat::format p)
     // m_access = static_cast<access>(acc);
     //m_width = static_cast<std::size_t>(w);
     //m_height = static_cast<std::size_t>(h);
+
+    // SDL takes the blend mode and the modulation of the surface
+    load_state();
+}
+
+void texture::render_nine_slice(const rect& dest, int left, int top, int right, int bottom)
+{
+    wsdl2_profile_zone("texture::render_nine_slice");
+    if (m_renderer.culled(dest))
+        return;
+
+    const std::array<int, 4> params {{left, top, right, bottom}};
+    const color mod = modulation();
+
+    if (!m_nine_slice)
+        m_nine_slice = std::make_unique<geometry>();
+
+    if (!m_nine_slice->matches(dest, params, mod)) {
+        nine_slice_quads(m_nine_slice->quads, m_width, m_height, dest, left, top, right, bottom);
+        m_nine_slice->build(dest, params, mod, m_width, m_height);
+    }
+
+    render_geometry(*m_nine_slice);
+}
+
+void texture::render_tiled(const rect& dest)
+{
+    wsdl2_profile_zone("texture::render_tiled");
+    if (m_renderer.culled(dest))
+        return;
+
+    const std::array<int, 4> params {{0, 0, 0, 0}};
+    const color mod = modulation();
+
+    if (!m_tiled)
+        m_tiled = std::make_unique<geometry>();
+
+    if (!m_tiled->matches(dest, params, mod)) {
+        tiled_quads(m_tiled->quads, m_width, m_height, dest);
+        m_tiled->build(dest, params, mod, m_width, m_height);
+    }
+
+    render_geometry(*m_tiled);
+}
+
+bool texture::update(surface& pixels, const rect& area)
+{
+    wsdl2_profile_zone("texture::update");
+
+    const bool locking = pixels.mustlock();
+    if (locking)
+        pixels.lock();
+
+    SDL_Surface *s = pixels.sdl();
+    const auto *first = static_cast<const std::uint8_t *>(s->pixels)
+        + area.y * s->pitch + area.x * s->format->BytesPerPixel;
+
+    const bool updated = util::check(0 == SDL_UpdateTexture(m_texture, &area, first, s->pitch));
+
+    if (locking)
+        pixels.unlock();
+
+    if (!updated)
+        return false;
+
+    m_renderer.m_stats.pixels_uploaded += static_cast<std::uint64_t>(area.w) * area.h;
+    return true;
+}
+
+void texture::render_geometry(geometry& g)
+{
+    if (g.quads.empty())
+        return;
+
+    // one submission, whatever the number of quads
+    m_renderer.count_copy(m_texture);
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    util::check(0 == SDL_RenderGeometry(m_renderer.sdl(), m_texture,
+        g.vertices.data(), static_cast<int>(g.vertices.size()),
+        g.indices.data(), static_cast<int>(g.indices.size())
+    ));
+#else
+    for (auto& q : g.quads)
+        util::check(0 == SDL_RenderCopy(m_renderer.sdl(), m_texture, &q.src, &q.dest));
+#endif
+}
+
+void texture::load_state() {
+    SDL_BlendMode mode;
+    if (util::check(0 == SDL_GetTextureBlendMode(m_texture, &mode)))
+        m_blend = to_blend_mode(mode);
+
+    util::check(0 == SDL_GetTextureAlphaMod(m_texture, &m_alpha));
+    util::check(0 == SDL_GetTextureColorMod(m_texture,
+        &m_color_mod.r, &m_color_mod.g, &m_color_mod.b));
+}
+
+color texture::modulation() const {
+    if (m_blend != blend_mode::premultiplied || m_alpha == 255)
+        return color {m_color_mod.r, m_color_mod.g, m_color_mod.b, m_alpha};
+
+    // the blend takes the colors as they are, fading the source alpha
+    // alone would brighten the result instead
+    auto fade = [this](std::uint8_t c) {
+        return static_cast<std::uint8_t>((c * m_alpha + 127) / 255);
+    };
+
+    return color {fade(m_color_mod.r), fade(m_color_mod.g), fade(m_color_mod.b), m_alpha};
+}
+
+bool texture::apply_color_mod() {
+    const color mod = modulation();
+    return 0 == SDL_SetTextureColorMod(m_texture, mod.r, mod.g, mod.b);
 }
 
 texture::~texture() {
     if (m_texture != NULL) {
         SDL_DestroyTexture(m_texture);
         npdebug("destroyed texture");
+
+        // SDL falls back to the window when the target is destroyed
+        if (m_renderer.m_target == m_texture) {
+            m_renderer.m_target = NULL;
+            m_renderer.load_state();
+        }
     }
 }
 
-std::shared_ptr<texture> static_texture::load(const std::string& path, renderer& r)
+std::shared_ptr<texture> static_texture::load(const std::string& path, renderer& r,
+    bool premultiplied /* = false */)
 {
-    npdebug("Loading ", path, " as surface")
+    npdebug("Loading ", path, " as surface");
     auto surf = surface::load(path);
     
-    npdebug(path, " loaded successfully")
+    npdebug(path, " loaded successfully");
+
+    // premultiplied colors drawn with another blend mode would be
+    // multiplied by alpha twice, keep them as they are instead
+    if (surf && premultiplied) {
+        if (!r.supports(blend_mode::premultiplied)) {
+            npdebug("premultiplied blending is not supported by the renderer");
+        } else if (surf->premultiply()) {
+            auto tex = std::make_shared<static_texture>(r, *surf);
+            tex->blend(blend_mode::premultiplied);
+
+            return std::static_pointer_cast<texture>(tex);
+        }
+    }
 
     if (surf) 
         return std::static_pointer_cast<texture>(std::make_shared<static_texture>(r, *surf));
@@ -250,6 +1001,132 @@ std::shared_ptr<texture> static_texture::load(const std::string& path, renderer&
     return nullptr; // nullopt
 }
 
+/* struct target_texture */
+
+bool target_texture::unpremultiply() {
+    wsdl2_profile_zone("target_texture::unpremultiply");
+
+    if (!is_target())
+        return false;
+
+    std::vector<std::uint32_t> pixels(static_cast<std::size_t>(m_width) * static_cast<std::size_t>(m_height));
+    const rect area {0, 0, m_width, m_height};
+
+    if (!util::check(0 == SDL_RenderReadPixels(m_renderer.sdl(), &area, SDL_PIXELFORMAT_ARGB8888,
+            pixels.data(), m_width * 4)))
+    {
+        return false;
+    }
+
+    for (std::uint32_t& p : pixels) {
+        const std::uint32_t a = p >> 24;
+        if (a == 0 || a == 255)
+            continue;
+
+        // rounded c * 255 / a, at most 255 for premultiplied colors
+        auto div = [a](std::uint32_t c) {
+            return std::min<std::uint32_t>((c * 255 + a / 2) / a, 255);
+        };
+
+        p = (a << 24)
+            | (div((p >> 16) & 0xff) << 16)
+            | (div((p >> 8) & 0xff) << 8)
+            | div(p & 0xff);
+    }
+
+    m_renderer.m_stats.pixels_uploaded += pixels.size();
+    return util::check(0 == SDL_UpdateTexture(sdl(), NULL, pixels.data(), m_width * 4));
+}
+
+/* struct static_texture */
+
+std::atomic<std::uint64_t> static_texture::_bytes_saved {0};
+
+pixelformat::format static_texture::reduced_format(surface& surf)
+{
+    SDL_Surface *s = surf.sdl();
+
+    // a color key becomes transparent pixels
+    bool transparent = (s->format->Amask != 0 || SDL_HasColorKey(s));
+    bool cut_out = true;
+
+    if (transparent) {
+        // converting turns the color key into alpha, even to the same format
+        const bool keyed = SDL_HasColorKey(s);
+        SDL_Surface *argb = (s->format->format == SDL_PIXELFORMAT_ARGB8888 && !keyed) ? s
+            : SDL_ConvertSurfaceFormat(s, SDL_PIXELFORMAT_ARGB8888, 0);
+
+        if (!util::check(argb != NULL))
+            return pixelformat::format::argb8888;
+
+        transparent = false;
+        SDL_LockSurface(argb);
+
+        for (int y = 0; y < argb->h && cut_out; y++) {
+            const auto *row = reinterpret_cast<const std::uint32_t *>(
+                static_cast<const std::uint8_t *>(argb->pixels) + y * argb->pitch);
+
+            for (int x = 0; x < argb->w; x++) {
+                const std::uint32_t a = row[x] >> 24;
+                if (a != 255)
+                    transparent = true;
+
+                if (a != 0 && a != 255) {
+                    cut_out = false;
+                    break;
+                }
+            }
+        }
+
+        SDL_UnlockSurface(argb);
+        if (argb != s)
+            SDL_FreeSurface(argb);
+    }
+
+    return !transparent ? pixelformat::format::rgb565
+        : cut_out ? pixelformat::format::argb1555
+        : pixelformat::format::argb4444;
+}
+
+pixelformat::format static_texture::reduced_format(renderer& r, surface& surf)
+{
+    const pixelformat::format f = reduced_format(surf);
+
+    if (!r.info().supports(f)) {
+        npdebug("the renderer has no ", SDL_GetPixelFormatName(static_cast<Uint32>(f)),
+                " textures, uploading at 32 bits per pixel");
+        return pixelformat::format::argb8888;
+    }
+
+    return f;
+}
+
+static_texture::static_texture(renderer& r, surface& surf, dither d)
+    : texture(r, texture::access::static_, surf.width(), surf.height(), reduced_format(r, surf))
+{
+    SDL_Surface *argb = SDL_ConvertSurfaceFormat(surf.sdl(), SDL_PIXELFORMAT_ARGB8888, 0);
+    if (!util::check(argb != NULL)) {
+        throw std::runtime_error("failed to convert a texture to reduce");
+    }
+
+    surface pixels(argb);
+
+    if (!pixels.convert(m_format, d) || !update(pixels)) {
+        throw std::runtime_error("failed to upload a reduced texture");
+    }
+
+    if (SDL_ISPIXELFORMAT_ALPHA(static_cast<Uint32>(m_format)))
+        blend(blend_mode::blend);
+
+    const std::size_t bytes_per_pixel = SDL_BYTESPERPIXEL(static_cast<Uint32>(m_format));
+    m_bytes_saved = static_cast<std::size_t>(m_width) * static_cast<std::size_t>(m_height)
+        * (4 - std::min<std::size_t>(bytes_per_pixel, 4));
+
+    _bytes_saved += m_bytes_saved;
+    npdebug("uploaded ", SDL_GetPixelFormatName(static_cast<Uint32>(m_format)),
+            " texture, ", m_bytes_saved, " bytes saved");
+}
+
 SDL_Texture* texture::sdl() {
 #ifdef DEBUG
     if (m_texture == NULL) {
@@ -274,40 +1151,130 @@ streaming_texture::streaming_texture(renderer& r, surface& surf, pixelformat::fo
 /* class window */
 
 // code used by events
-std::unordered_map<unsigned, window*> window::_windows;
+std::vector<window::slot> window::_windows;
+
+std::size_t window::_window_count = 0;
+
+// index of the slot of id, or of the empty slot ending its probe sequence
+std::size_t window::probe(unsigned id) {
+    const std::size_t mask = _windows.size() - 1;
+
+    std::size_t i = id & mask;
+    while (_windows[i].win != nullptr && _windows[i].id != id)
+        i = (i + 1) & mask;
+
+    return i;
+}
+
+void window::register_window(window *w) {
+    // at most half full, so that probe sequences stay short; the size
+    // follows the number of open windows, not the values of their ids
+    if (_windows.size() < 2 * (_window_count + 1)) {
+        std::vector<slot> old(std::max<std::size_t>(16, _windows.size() * 2));
+        old.swap(_windows);
+
+        for (const slot& o : old) {
+            if (o.win != nullptr)
+                _windows[probe(o.id)] = o;
+        }
+    }
+
+    slot& s = _windows[probe(w->m_id)];
+    if (s.win == nullptr)
+        _window_count++;
+
+    s.id = w->m_id;
+    s.win = w;
+}
+
+void window::unregister_window(window *w) {
+    if (_windows.empty())
+        return;
+
+    const std::size_t mask = _windows.size() - 1;
+    std::size_t i = probe(w->m_id);
+
+    // a moved-from window must not remove its successor
+    if (_windows[i].win != w)
+        return;
+
+    _windows[i] = slot();
+    _window_count--;
+
+    // move back the following slots of the run that could not be found
+    // anymore through the emptied one
+    for (std::size_t j = (i + 1) & mask; _windows[j].win != nullptr; j = (j + 1) & mask) {
+        const std::size_t home = _windows[j].id & mask;
+
+        // home is cyclically in (i, j], the slot is still reachable
+        const bool reachable = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+        if (reachable)
+            continue;
+
+        _windows[i] = _windows[j];
+        _windows[j] = slot();
+        i = j;
+    }
+}
 
 window::window(window&& other)
     : m_open(other.m_open),
       m_window(other.m_window),
       m_id(other.m_id),
-      m_renderer(std::move(other.m_renderer))
+      m_renderer(std::move(other.m_renderer)),
+      m_events(std::move(other.m_events))
 {
     other.m_window = NULL;
+    register_window(this);
+}
+
+static SDL_Window * create_window(const std::string& title, int width, int height)
+{
+    // create (hidden) window
+    SDL_Window *win = SDL_CreateWindow(
+        title.c_str(),
+        SDL_WINDOWPOS_CENTERED,
+        SDL_WINDOWPOS_CENTERED,
+        width, height,
+        SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN
+    );
+
+    // the video driver may have no OpenGL support (e.g. dummy)
+    if (win == NULL) {
+        win = SDL_CreateWindow(
+            title.c_str(),
+            SDL_WINDOWPOS_CENTERED,
+            SDL_WINDOWPOS_CENTERED,
+            width, height,
+            SDL_WINDOW_HIDDEN
+        );
+    }
+
+    return win;
 }
 
 window::window(const std::string& title, std::size_t width, std::size_t height)
+    : window(title, width, height, renderer_config()) {}
+
+window::window(const std::string& title, std::size_t width, std::size_t height,
+    const renderer_config& config)
     : m_open(false),
-      // create (hidden) window
-      m_window(SDL_CreateWindow(
-          title.c_str(),
-          SDL_WINDOWPOS_CENTERED,
-          SDL_WINDOWPOS_CENTERED,
+      m_window(create_window(title,
           static_cast<int>(width),
-          static_cast<int>(height),
-          SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN
+          static_cast<int>(height)
       )),
       m_id(SDL_GetWindowID(m_window)),
-      m_renderer(new renderer(m_window))
+      m_renderer(new renderer(m_window, config))
 {
     // put into window id mapping
-    _windows.insert({m_id, this});
+    register_window(this);
 
     npdebug("creaded window");
 }
 
 window::~window() {
     // remove from window id mapping
-    _windows.erase(m_id);
+    unregister_window(this);
 
     // destroy renderer
     m_renderer.reset();
@@ -350,10 +1317,36 @@ SDL_Window * window::sdl() {
     return m_window;
 }
 
+std::optional<event::any> window::poll()
+{
+    while (!m_events.empty()) {
+        SDL_Event ev = m_events.front();
+        m_events.pop_front();
+
+        if (auto e = event::translate(ev))
+            return e;
+    }
+
+    return std::nullopt;
+}
+
 /* static members for class window */
+window* window::find(unsigned id)
+{
+    if (id == 0 || _windows.empty())
+        return nullptr;
+
+    return _windows[probe(id)].win;
+}
+
 window& window::get(unsigned id)
 {
-    return *window::_windows[id];
+    window *w = find(id);
+    if (w == nullptr) {
+        throw std::out_of_range("no window with id " + std::to_string(id));
+    }
+
+    return *w;
 }
 
 wsdl2::point window::size() const
@@ -363,3 +1356,16 @@ wsdl2::point window::size() const
 
     return out;
 }
+
+
+/* class canvas */
+
+canvas::canvas(int width, int height, pixelformat::format p)
+    : m_surface(SDL_CreateRGBSurfaceWithFormat(0, width, height,
+          static_cast<int>(SDL_BITSPERPIXEL(static_cast<Uint32>(p))),
+          static_cast<Uint32>(p)
+      )),
+      m_renderer(new renderer(m_surface))
+{
+    npdebug("created canvas");
+}
@@ -0,0 +1,210 @@
+#include "wsdl2/virtual_texture.hpp"
+#include "wsdl2/debug.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+extern "C" {
+#include <SDL2/SDL_rwops.h>
+}
+
+using namespace wsdl2;
+
+// a tile must fit in a single texture of the renderer
+static int fitting_tile_size(renderer& r, int tile_size) {
+    if (tile_size <= 0) {
+        throw std::invalid_argument("virtual_texture needs a positive tile size");
+    }
+
+    const renderer_info info = r.info();
+    if (info.max_texture_width > 0)
+        tile_size = std::min(tile_size, info.max_texture_width);
+    if (info.max_texture_height > 0)
+        tile_size = std::min(tile_size, info.max_texture_height);
+
+    return tile_size;
+}
+
+virtual_texture::virtual_texture(renderer& r, int width, int height, loader l,
+    int tile_size /* = 512 */, std::size_t memory_budget /* = 64 << 20 */)
+    : m_renderer(r),
+      m_load(std::move(l)),
+      m_width(width),
+      m_height(height),
+      m_tile_size(fitting_tile_size(r, tile_size)),
+      m_capacity(std::max<std::size_t>(memory_budget / tile_bytes(), 1)),
+      m_staging(SDL_CreateRGBSurfaceWithFormat(0, m_tile_size, m_tile_size, 32,
+          SDL_PIXELFORMAT_ARGB8888))
+{
+    npdebug("virtual texture of ", width, "x", height, " in tiles of ", m_tile_size,
+            ", at most ", m_capacity, " cached");
+}
+
+virtual_texture::virtual_texture(renderer& r, surface& image,
+    int tile_size /* = 512 */, std::size_t memory_budget /* = 64 << 20 */)
+    : virtual_texture(r, image.width(), image.height(),
+        [&image](const rect& region, surface& dest) {
+            SDL_BlendMode mode;
+            SDL_GetSurfaceBlendMode(image.sdl(), &mode);
+
+            // copy the alpha channel as it is instead of blending
+            SDL_SetSurfaceBlendMode(image.sdl(), SDL_BLENDMODE_NONE);
+
+            // a color key still skips pixels, which must not keep what
+            // the previous tile left there
+            rect to {0, 0, region.w, region.h};
+            const bool copied = util::check(0 == SDL_FillRect(dest.sdl(), &to, 0))
+                && util::check(0 == SDL_BlitSurface(image.sdl(), &region, dest.sdl(), &to));
+
+            SDL_SetSurfaceBlendMode(image.sdl(), mode);
+            return copied;
+        },
+        tile_size, memory_budget)
+{}
+
+virtual_texture::loader virtual_texture::raw_file(const std::string& path, int width, int height)
+{
+    std::shared_ptr<SDL_RWops> file(SDL_RWFromFile(path.c_str(), "rb"),
+        [](SDL_RWops *f) { if (f != NULL) SDL_RWclose(f); }
+    );
+
+    if (!util::check(file != nullptr)) {
+        throw std::runtime_error("failed to open " + path);
+    }
+
+    return [file, width, height](const rect& region, surface& dest) {
+        if (region.x + region.w > width || region.y + region.h > height)
+            return false;
+
+        SDL_Surface *s = dest.sdl();
+        const std::size_t bytes = static_cast<std::size_t>(region.w) * 4;
+        auto *row = static_cast<std::uint8_t *>(s->pixels);
+
+        for (int y = 0; y < region.h; y++, row += s->pitch) {
+            const Sint64 offset = (static_cast<Sint64>(region.y + y) * width + region.x) * 4;
+
+            if (SDL_RWseek(file.get(), offset, RW_SEEK_SET) < 0
+                || SDL_RWread(file.get(), row, 1, bytes) != bytes)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    };
+}
+
+void virtual_texture::invalidate() {
+    m_index.clear();
+    m_cache.clear();
+}
+
+streaming_texture *virtual_texture::fetch(int tx, int ty) {
+    const std::uint64_t key = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(ty)) << 32)
+        | static_cast<std::uint32_t>(tx);
+
+    auto found = m_index.find(key);
+    if (found != m_index.end()) {
+        // splicing keeps the iterator valid
+        m_cache.splice(m_cache.begin(), m_cache, found->second);
+        found->second->frame = m_frame;
+        return found->second->tex.get();
+    }
+
+    std::unique_ptr<streaming_texture> tex;
+
+    if (m_cache.size() >= m_capacity) {
+        // the used tiles are in front, if the last one is used so are all
+        tile& last = m_cache.back();
+        if (last.frame == m_frame) {
+            m_missing++;
+            return nullptr;
+        }
+
+        tex = std::move(last.tex);
+        m_index.erase(last.key);
+        m_cache.pop_back();
+    } else {
+        tex = std::make_unique<streaming_texture>(m_renderer, m_tile_size, m_tile_size,
+            pixelformat::format::argb8888
+        );
+        tex->blend(blend_mode::blend);
+    }
+
+    const rect region {
+        tx * m_tile_size, ty * m_tile_size,
+        std::min(m_tile_size, m_width - tx * m_tile_size),
+        std::min(m_tile_size, m_height - ty * m_tile_size)
+    };
+
+    {
+        wsdl2_profile_zone("virtual_texture::load");
+
+        if (!m_load(region, m_staging)) {
+            wsdl2_log(warn, "could not load tile ", tx, ",", ty, " of a virtual texture");
+            return nullptr;
+        }
+    }
+
+    if (!tex->update(m_staging, rect {0, 0, region.w, region.h}))
+        return nullptr;
+
+    m_loaded++;
+    m_cache.push_front(tile {key, std::move(tex), m_frame});
+    m_index[key] = m_cache.begin();
+
+    return m_cache.front().tex.get();
+}
+
+void virtual_texture::render(const rect& view, const rect& dest) {
+    wsdl2_profile_zone("virtual_texture::render");
+
+    m_frame++;
+    m_drawn = 0;
+    m_loaded = 0;
+    m_missing = 0;
+
+    if (view.w <= 0 || view.h <= 0)
+        return;
+
+    const auto visible = view.intersection(rect {0, 0, m_width, m_height});
+    if (!visible)
+        return;
+
+    // both edges of a part are mapped, so that neighbours share them
+    auto map_x = [&](int x) {
+        return dest.x + static_cast<int>(static_cast<std::int64_t>(x - view.x) * dest.w / view.w);
+    };
+
+    auto map_y = [&](int y) {
+        return dest.y + static_cast<int>(static_cast<std::int64_t>(y - view.y) * dest.h / view.h);
+    };
+
+    const int ts = m_tile_size;
+    const int tx0 = visible->x / ts;
+    const int ty0 = visible->y / ts;
+    const int tx1 = (visible->x + visible->w - 1) / ts;
+    const int ty1 = (visible->y + visible->h - 1) / ts;
+
+    for (int ty = ty0; ty <= ty1; ty++) {
+        for (int tx = tx0; tx <= tx1; tx++) {
+            streaming_texture *tex = fetch(tx, ty);
+            if (tex == nullptr)
+                continue;
+
+            // the visible part of the tile, in image coordinates
+            const int x0 = std::max(tx * ts, visible->x);
+            const int y0 = std::max(ty * ts, visible->y);
+            const int x1 = std::min((tx + 1) * ts, visible->x + visible->w);
+            const int y1 = std::min((ty + 1) * ts, visible->y + visible->h);
+
+            rect src {x0 - tx * ts, y0 - ty * ts, x1 - x0, y1 - y0};
+            tex->render(src, rect {
+                map_x(x0), map_y(y0),
+                map_x(x1) - map_x(x0), map_y(y1) - map_y(y0)
+            });
+
+            m_drawn++;
+        }
+    }
+}
@@ -1,6 +1,11 @@
 #include "wsdl2/wsdl2.hpp"
 #include "wsdl2/debug.hpp"
 #include "wsdl2/util.hpp"
+#include "wsdl2/log.hpp"
+
+#ifdef WSDL2_THREADS
+#include "wsdl2/jobs.hpp"
+#endif
 
 extern "C" {
 #include <SDL2/SDL.h>
@@ -44,11 +49,19 @@ bool wsdl2::initialize(void) {
     npdebug("initialized SDL2_ttf");
 #endif
 
+#ifdef WSDL2_THREADS
+    jobs::start();
+#endif
+
     return true;
 }
 
 void wsdl2::quit(void) {
 
+#ifdef WSDL2_THREADS
+    jobs::stop();
+#endif
+
 #ifdef WSDL2_TTF
     TTF_Quit();
     npdebug("deinitialized SDL2_ttf");
@@ -67,6 +80,9 @@ void wsdl2::quit(void) {
 
     SDL_Quit();
     npdebug("deinitialized SDL2");
+
+    // before static destruction, which has no defined order
+    log::stop();
 }
 
 